@@ -210,7 +210,7 @@ static int 	f_w;
 static int	f_h;
 
 static int 	lightlev; 		// used for funky strobing effect
-static byte*	fb; 			// pseudo-frame buffer
+static pixel_t*	fb; 			// pseudo-frame buffer
 static int 	amclock;
 
 static mpoint_t m_paninc; // how far the window pans each tic (map coords)
@@ -833,7 +833,27 @@ void AM_Ticker (void)
 //
 void AM_clearFB(int color)
 {
+#if defined(FEATURE_RGB565_VIDEO)
+    int x, y;
+    pixel_t* dest;
+    pixel_t pixel = I_PIXEL(color);
+
+    // Columns are contiguous, from the bottom up.
+    for (x = 0; x < f_w; x++)
+    {
+	dest = fb + SCREENOFFSET(x, f_h-1);
+	for (y = 0; y < f_h; y++)
+	    *dest++ = pixel;
+    }
+#elif defined(FEATURE_COLUMN_MAJOR_VIDEO)
+    int x;
+
+    // Columns are contiguous, from the bottom up.
+    for (x = 0; x < f_w; x++)
+	memset(fb + SCREENOFFSET(x, f_h-1), color, f_h);
+#else
     memset(fb, color, f_w*f_h);
+#endif
 }
 
 
@@ -1007,7 +1027,7 @@ AM_drawFline
 	return;
     }
 
-#define PUTDOT(xx,yy,cc) fb[(yy)*f_w+(xx)]=(cc)
+#define PUTDOT(xx,yy,cc) fb[SCREENOFFSET(xx,yy)]=I_PIXEL(cc)
 
     dx = fl->b.x - fl->a.x;
     ax = 2 * (dx<0 ? -dx : dx);
@@ -1331,7 +1351,7 @@ void AM_drawMarks(void)
 
 void AM_drawCrosshair(int color)
 {
-    fb[(f_w*(f_h+1))/2] = color; // single point for now
+    fb[SCREENOFFSET(f_w/2, f_h/2)] = I_PIXEL(color); // single point for now
 
 }
 
@@ -129,6 +129,9 @@ char		wadfile[1024];		// primary wad file
 char		mapdir[1024];           // directory of development maps
 
 int             show_endoom = 1;
+#ifdef FEATURE_FRAME_GOVERNOR
+int             governor_fps = TICRATE;         // see D_GovernedDisplay
+#endif
 
 
 void D_ConnectNetGame(void);
@@ -177,6 +180,9 @@ void D_Display (void)
     static  boolean		fullscreen = false;
     static  gamestate_t		oldgamestate = -1;
     static  int			borderdrawcount;
+#ifdef FEATURE_RGB565_VIDEO
+    static  const uint16_t*	borderpalette;
+#endif
     int				nowtime;
     int				tics;
     int				wipestart;
@@ -187,6 +193,8 @@ void D_Display (void)
 
     if (nodrawers)
     	return;                    // for comparative timing / profiling
+
+    I_WaitUpdate ();           // the last frame may still be on its way
 		
     redrawsbar = false;
     
@@ -263,6 +271,15 @@ void D_Display (void)
     // see if the border needs to be updated to the screen
     if (gamestate == GS_LEVEL && !automapactive && scaledviewwidth != 320)
     {
+#ifdef FEATURE_RGB565_VIDEO
+		// the back screen holds pixels of the palette it was drawn with
+		if (borderpalette != rgb565_palette)
+		{
+			borderpalette = rgb565_palette;
+			R_FillBackScreen ();
+			borderdrawcount = 3;
+		}
+#endif
 		if (menuactive || menuactivestate || !viewactivestate)
 			borderdrawcount = 3;
 		if (borderdrawcount)
@@ -323,6 +340,7 @@ void D_Display (void)
 	} while (tics <= 0);
         
 	wipestart = nowtime;
+	I_WaitUpdate ();
 	done = wipe_ScreenWipe(wipe_Melt
 			       , 0, 0, SCREENWIDTH, SCREENHEIGHT, tics);
 	I_UpdateNoBlit ();
@@ -370,6 +388,10 @@ void D_BindVariables(void)
     M_BindVariable("vanilla_savegame_limit", &vanilla_savegame_limit);
     M_BindVariable("vanilla_demo_limit",     &vanilla_demo_limit);
     M_BindVariable("show_endoom",            &show_endoom);
+    M_BindVariable("composite_budget",       &composite_budget);
+#ifdef FEATURE_FRAME_GOVERNOR
+    M_BindVariable("governor_fps",           &governor_fps);
+#endif
 
     // Multiplayer chat macros
 
@@ -408,8 +430,191 @@ boolean D_GrabMouseCallback(void)
 //
 //  D_DoomLoop
 //
+
+// Number of tics between the periodic zone statistics dumps
+
+#define ZONE_STATS_PERIOD (10 * TICRATE)
+
+#ifdef FEATURE_FRAME_GOVERNOR
+
+//
+// Frame governor
+//
+// Holds the frame rate at governor_fps by stepping down from the menu
+// settings when frames overrun, first to low detail and then shrinking
+// the view a block at a time, and back up when the display work leaves
+// enough headroom. The menu settings themselves are left untouched.
+// Below TICRATE the frames are also capped to governor_fps, which
+// leaves the processor idle the rest of the time. 0 turns it off.
+//
+
+#define GOVERNOR_FRAMES		16	// frames in the rolling window
+#define GOVERNOR_MINBLOCKS	7	// smallest view size stepped down to
+#define GOVERNOR_MAXHOLD	16	// most windows to wait for a step up
+#define GOVERNOR_HITCH		250	// ms; longer frames are not counted
+
+static int governorlevel;		// steps down from the menu settings
+static int governorblocks;		// menu settings the level applies to
+static int governordetail;
+static int governorhold;		// windows to wait before a step up
+static int governorwait;
+static boolean governorstepped;		// the last change was a step up
+static int governorframes;		// frames in the current window
+static int governorelapsed;		// ms from frame to frame
+static int governorbusy;		// ms spent in D_Display
+static int governorlast;		// time the previous frame started
+static int governortic;			// gametic of the previous frame
+static int governorcredit;		// frame rate cap, in fps * tics
+
+//
+// D_GovernorLevels
+// Number of steps down available from the menu settings.
+//
+static int D_GovernorLevels (void)
+{
+    int		levels;
+
+    levels = !detailLevel;
+
+    if (screenblocks > GOVERNOR_MINBLOCKS)
+	levels += screenblocks - GOVERNOR_MINBLOCKS;
+
+    return levels;
+}
+
+//
+// D_GovernorStep
+// Changes the level, taking effect at the start of the next frame.
+//
+static void D_GovernorStep (int step)
+{
+    int		blocks;
+    int		detail;
+    int		level;
+
+    governorlevel += step;
+
+    blocks = screenblocks;
+    detail = detailLevel;
+    level = governorlevel;
+
+    if (level > 0 && !detail)
+    {
+	detail = 1;
+	level--;
+    }
+
+    R_SetViewSize (blocks - level, detail);
+
+    governorframes = governorelapsed = governorbusy = 0;
+}
+
+//
+// D_GovernedDisplay
+// D_Display, timed and paced by the governor.
+//
+static void D_GovernedDisplay (void)
+{
+    int		start;
+    int		budget;
+
+    if (governor_fps <= 0)
+    {
+	if (governorlevel)
+	    D_GovernorStep (-governorlevel);
+	D_Display ();
+	return;
+    }
+
+    // cap the frame rate, by whole frames per tic run
+    if (governor_fps < TICRATE)
+    {
+	governorcredit += (gametic - governortic) * governor_fps;
+	governortic = gametic;
+
+	if (governorcredit > 2*TICRATE)
+	    governorcredit = 2*TICRATE;
+
+	if (governorcredit < TICRATE)
+	    return;
+
+	governorcredit -= TICRATE;
+    }
+
+    // the menu settings changed: start over from them
+    if (screenblocks != governorblocks || detailLevel != governordetail)
+    {
+	governorblocks = screenblocks;
+	governordetail = detailLevel;
+	governorlevel = 0;
+	governorhold = 1;
+	governorwait = 0;
+	governorframes = governorelapsed = governorbusy = 0;
+    }
+
+    start = I_GetTimeMS ();
+    D_Display ();
+
+    // only time the 3D view, without wipes and level loads
+    if (gamestate != GS_LEVEL || automapactive
+     || start - governorlast > GOVERNOR_HITCH)
+    {
+	governorframes = governorelapsed = governorbusy = 0;
+	governorlast = start;
+	return;
+    }
+
+    governorelapsed += start - governorlast;
+    governorbusy += I_GetTimeMS () - start;
+    governorlast = start;
+
+    if (++governorframes < GOVERNOR_FRAMES)
+	return;
+
+    // frames come at most once a tic
+    if (governor_fps < TICRATE)
+	budget = GOVERNOR_FRAMES * 1000 / governor_fps;
+    else
+	budget = GOVERNOR_FRAMES * 1000 / TICRATE;
+
+    if (governorelapsed > budget + budget/8
+     && governorlevel < D_GovernorLevels ())
+    {
+	// overrun: step down; if it undoes a step up, wait
+	//  longer before trying that one again
+	if (governorstepped && governorhold < GOVERNOR_MAXHOLD)
+	    governorhold *= 2;
+
+	governorstepped = false;
+	governorwait = 0;
+	D_GovernorStep (1);
+    }
+    else if (governorbusy < budget/2
+	  && governorlevel > 0
+	  && ++governorwait >= governorhold)
+    {
+	// headroom: step up
+	governorstepped = true;
+	governorwait = 0;
+	D_GovernorStep (-1);
+    }
+    else
+    {
+	if (governorelapsed <= budget)
+	    governorstepped = false;
+	governorframes = governorelapsed = governorbusy = 0;
+    }
+}
+
+#endif
+
 void D_DoomLoop (void)
 {
+#ifdef FEATURE_ZONE_STATS
+    int zonestatstic = 0;
+    int zonestatsframes = 0;
+#endif
+
     if (bfgedition &&
         (demorecording || (gameaction == ga_playdemo) || netgame))
     {
@@ -437,6 +642,11 @@ void D_DoomLoop (void)
     V_RestoreBuffer();
     R_ExecuteSetViewSize();
 
+#ifdef FEATURE_ZONE_STATS
+    // before the game loop starts its clock
+    M_TimeFixed ();
+#endif
+
     D_StartGameLoop();
 
     if (testcontrols)
@@ -456,8 +666,28 @@ void D_DoomLoop (void)
         // Update display, next frame, with current state.
         if (screenvisible)
         {
+#ifdef FEATURE_FRAME_GOVERNOR
+            D_GovernedDisplay ();
+#else
             D_Display ();
+#endif
+#ifdef FEATURE_ZONE_STATS
+            zonestatsframes++;
+#endif
         }
+
+#ifdef FEATURE_ZONE_STATS
+        // Report the zone usage every now and then
+        if (gametic - zonestatstic >= ZONE_STATS_PERIOD)
+        {
+            zonestatstic = gametic;
+            Z_DumpStats ();
+            R_DumpLimits ();
+            I_DumpPresentStats ();
+            M_DumpFixedStats (zonestatsframes);
+            zonestatsframes = 0;
+        }
+#endif
     }
     return;
 }
@@ -1832,8 +2062,7 @@ static int runonce = 0;
 
     if (startloadgame >= 0)
     {
-        M_StringCopy(file, P_SaveGameFile(startloadgame), sizeof(file));
-        G_LoadGame(file);
+        G_LoadGame(startloadgame);
     }
 
     if (gameaction != ga_loadgame )
@@ -35,6 +35,44 @@
 
 #undef FEATURE_SOUND
 
+// Enables a periodic dump of the zone memory statistics (Z_DumpStats),
+// the renderer limits, the LCD frame pacing and the FixedMul and
+// FixedDiv calls per frame
+
+#undef FEATURE_ZONE_STATS
+
+// Sizes the zone from the SDRAM left free between the end of .bss
+// and the reserved WAD region, instead of the fixed DEFAULT_RAM
+
+#undef FEATURE_ZONE_FROM_SDRAM
+
+// Lays out the screen buffers column by column (see SCREENOFFSET),
+// in the order of the rotated LCD frame buffer
+
+#undef FEATURE_COLUMN_MAJOR_VIDEO
+
+// Renders RGB565 pixels straight into the LCD frame buffer, through
+// colormaps converted for the active palette (see pixel_t).
+// Requires FEATURE_COLUMN_MAJOR_VIDEO.
+
+#undef FEATURE_RGB565_VIDEO
+
+// Hands the 8-bit screen to the display path as it is, converted by the
+// DMA2D through a hardware CLUT loaded with the palette.
+// Requires FEATURE_COLUMN_MAJOR_VIDEO, excludes FEATURE_RGB565_VIDEO.
+
+#undef FEATURE_CLUT_VIDEO
+
+// Wraps wall textures at their own height instead of at 128 rows, as
+// vanilla does, which fixes tall textures and short repeating ones
+
+#undef FEATURE_TALL_TEXTURES
+
+// Steps the detail and the view size down from the menu settings when
+// frames overrun the governor_fps target, and back up with headroom
+
+#undef FEATURE_FRAME_GOVERNOR
+
 #endif /* #ifndef DOOM_FEATURES_H */
 
 
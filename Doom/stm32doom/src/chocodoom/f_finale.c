@@ -227,7 +227,7 @@ extern	patch_t *hu_font[HU_FONTSIZE];
 void F_TextWrite (void)
 {
     byte*	src;
-    byte*	dest;
+    pixel_t*	dest;
     
     int		x,y,w;
     signed int	count;
@@ -238,6 +238,19 @@ void F_TextWrite (void)
     
     // erase the entire screen to a tiled background
     src = W_CacheLumpName ( finaleflat , PU_CACHE);
+
+#ifdef FEATURE_COLUMN_MAJOR_VIDEO
+    for (x=0 ; x<SCREENWIDTH ; x++)
+    {
+	dest = I_VideoBuffer + SCREENOFFSET(x, 0);
+
+	for (y=0 ; y<SCREENHEIGHT ; y++)
+	{
+	    *dest = I_PIXEL(src[((y&63)<<6) + (x&63)]);
+	    dest += SCREENPITCH_Y;
+	}
+    }
+#else
     dest = I_VideoBuffer;
 	
     for (y=0 ; y<SCREENHEIGHT ; y++)
@@ -253,6 +266,7 @@ void F_TextWrite (void)
 	    dest += (SCREENWIDTH&63);
 	}
     }
+#endif
 
     V_MarkRect (0, 0, SCREENWIDTH, SCREENHEIGHT);
     
@@ -576,24 +590,24 @@ F_DrawPatchCol
 {
     column_t*	column;
     byte*	source;
-    byte*	dest;
-    byte*	desttop;
+    pixel_t*	dest;
+    pixel_t*	desttop;
     int		count;
 	
     column = (column_t *)((byte *)patch + LONG(patch->columnofs[col]));
-    desttop = I_VideoBuffer + x;
+    desttop = I_VideoBuffer + SCREENOFFSET(x, 0);
 
     // step through the posts in a column
     while (column->topdelta != 0xff )
     {
 	source = (byte *)column + 3;
-	dest = desttop + column->topdelta*SCREENWIDTH;
+	dest = desttop + column->topdelta*SCREENPITCH_Y;
 	count = column->length;
 		
 	while (count--)
 	{
-	    *dest = *source++;
-	    dest += SCREENWIDTH;
+	    *dest = I_PIXEL(*source++);
+	    dest += SCREENPITCH_Y;
 	}
 	column = (column_t *)(  (byte *)column + column->length + 4 );
     }
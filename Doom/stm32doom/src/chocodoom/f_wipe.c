@@ -24,6 +24,7 @@
 #include "m_random.h"
 
 #include "doomtype.h"
+#include "doomstat.h"
 
 #include "f_wipe.h"
 
@@ -34,32 +35,21 @@
 // when zero, stop the wipe
 static boolean	go = 0;
 
-static byte*	wipe_scr_start;
-static byte*	wipe_scr_end;
-static byte*	wipe_scr;
+// The start screen snapshot is kept for the whole run, so that
+// wipes do not have to allocate. The end screen stays where it
+// was drawn, in I_VideoBuffer.
+static pixel_t*	wipe_scr_start;
+static pixel_t*	wipe_scr_end;
+static pixel_t*	wipe_scr;
 
+// When the melt is composed into I_VideoBuffer (see wipe_composeMelt),
+// it is composed from a snapshot of the end screen, allocated only
+// while it is needed; otherwise NULL.
+static pixel_t*	wipe_scr_meltend;
 
-void
-wipe_shittyColMajorXform
-( short*	array,
-  int		width,
-  int		height )
-{
-    int		x;
-    int		y;
-    short*	dest;
-
-    dest = (short*) Z_Malloc(width*height*2, PU_STATIC, 0);
+// true while a melt is in progress, see wipe_MeltOffsets
+static boolean	melting = false;
 
-    for(y=0;y<height;y++)
-	for(x=0;x<width;x++)
-	    dest[x*height+y] = array[y*width+x];
-
-    memcpy(array, dest, width*height*2);
-
-    Z_Free(dest);
-
-}
 
 int
 wipe_initColorXForm
@@ -67,7 +57,11 @@ wipe_initColorXForm
   int	height,
   int	ticks )
 {
-    memcpy(wipe_scr, wipe_scr_start, width*height);
+    // this wipe fades the pixels in place, so it needs
+    // its own copy of the end screen
+    wipe_scr_end = Z_Malloc(width*height*sizeof(pixel_t), PU_STATIC, NULL);
+    memcpy(wipe_scr_end, wipe_scr, width*height*sizeof(pixel_t));
+    memcpy(wipe_scr, wipe_scr_start, width*height*sizeof(pixel_t));
     return 0;
 }
 
@@ -78,8 +72,8 @@ wipe_doColorXForm
   int	ticks )
 {
     boolean	changed;
-    byte*	w;
-    byte*	e;
+    pixel_t*	w;
+    pixel_t*	e;
     int		newval;
 
     changed = false;
@@ -123,11 +117,91 @@ wipe_exitColorXForm
   int	height,
   int	ticks )
 {
+    Z_Free(wipe_scr_end);
     return 0;
 }
 
 
-static int*	y;
+// Melt offset of each two pixel wide column: rows of the end
+// screen shown above the start screen (y<0 => not ready to scroll yet)
+static int	melt_y[SCREENWIDTH/2];
+
+//
+// wipe_drawMelt
+// Composes the melt into I_VideoBuffer: the start screen pushed
+// down by each column's offset, below the top of the end screen.
+//
+static void
+wipe_drawMelt
+( int	width,
+  int	height )
+{
+    int		x;
+    int		dy;
+    pixel_t*	dest;
+#ifndef FEATURE_COLUMN_MAJOR_VIDEO
+    int		y;
+#endif
+
+    for (x=0;x<width;x++)
+    {
+	dy = melt_y[x/2];
+	if (dy < 0) dy = 0;
+	else if (dy > height) dy = height;
+
+#ifdef FEATURE_COLUMN_MAJOR_VIDEO
+	// columns are contiguous, from the bottom up
+	dest = &I_VideoBuffer[SCREENOFFSET(x, height-1)];
+	memcpy(dest, &wipe_scr_start[SCREENOFFSET(x, height-1-dy)],
+	       (height-dy)*sizeof(pixel_t));
+	memcpy(dest+height-dy, &wipe_scr_meltend[SCREENOFFSET(x, dy-1)],
+	       dy*sizeof(pixel_t));
+#else
+	dest = &I_VideoBuffer[x];
+	for (y=0;y<dy;y++, dest+=SCREENWIDTH)
+	    *dest = wipe_scr_meltend[SCREENOFFSET(x, y)];
+	for (;y<height;y++, dest+=SCREENWIDTH)
+	    *dest = wipe_scr_start[SCREENOFFSET(x, y-dy)];
+#endif
+    }
+}
+
+//
+// wipe_composeMelt
+// With SCREENDIRECT the melt is always composed into I_VideoBuffer.
+// Otherwise I_FinishUpdate composes it and I_VideoBuffer keeps the
+// end screen, except while the menu is up: the menu is drawn into
+// I_VideoBuffer and has to be on top of the whole melting screen.
+//
+static void
+wipe_composeMelt
+( int	width,
+  int	height )
+{
+#ifndef SCREENDIRECT
+    if (!menuactive)
+    {
+	if (wipe_scr_meltend != NULL)
+	{
+	    // the menu went away, put the end screen back
+	    memcpy(I_VideoBuffer, wipe_scr_meltend,
+		   width*height*sizeof(pixel_t));
+	    Z_Free(wipe_scr_meltend);
+	    wipe_scr_meltend = NULL;
+	}
+	return;
+    }
+#endif
+
+    if (wipe_scr_meltend == NULL)
+    {
+	// the end screen is about to be drawn over
+	wipe_scr_meltend = Z_Malloc(width*height*sizeof(pixel_t), PU_STATIC, NULL);
+	I_ReadScreen(wipe_scr_meltend);
+    }
+
+    wipe_drawMelt(width, height);
+}
 
 int
 wipe_initMelt
@@ -137,26 +211,24 @@ wipe_initMelt
 {
     int i, r;
     
-    // copy start screen to main screen
-    memcpy(wipe_scr, wipe_scr_start, width*height);
-    
-    // makes this wipe faster (in theory)
-    // to have stuff in column-major format
-    wipe_shittyColMajorXform((short*)wipe_scr_start, width/2, height);
-    wipe_shittyColMajorXform((short*)wipe_scr_end, width/2, height);
-    
     // setup initial column positions
     // (y<0 => not ready to scroll yet)
-    y = (int *) Z_Malloc(width*sizeof(int), PU_STATIC, 0);
-    y[0] = -(M_Random()%16);
+    width/=2;
+    melt_y[0] = -(M_Random()%16);
     for (i=1;i<width;i++)
     {
 	r = (M_Random()%3) - 1;
-	y[i] = y[i-1] + r;
-	if (y[i] > 0) y[i] = 0;
-	else if (y[i] == -16) y[i] = -15;
+	melt_y[i] = melt_y[i-1] + r;
+	if (melt_y[i] > 0) melt_y[i] = 0;
+	else if (melt_y[i] == -16) melt_y[i] = -15;
     }
 
+    // the screen is composed from the start and end screens
+    // by I_FinishUpdate, nothing is moved here...
+    melting = true;
+    // ...unless it has to be composed in I_VideoBuffer
+    wipe_composeMelt(width*2, height);
+
     return 0;
 }
 
@@ -167,12 +239,7 @@ wipe_doMelt
   int	ticks )
 {
     int		i;
-    int		j;
     int		dy;
-    int		idx;
-    
-    short*	s;
-    short*	d;
     boolean	done = true;
 
     width/=2;
@@ -181,36 +248,22 @@ wipe_doMelt
     {
 	for (i=0;i<width;i++)
 	{
-	    if (y[i]<0)
+	    if (melt_y[i]<0)
 	    {
-		y[i]++; done = false;
+		melt_y[i]++; done = false;
 	    }
-	    else if (y[i] < height)
+	    else if (melt_y[i] < height)
 	    {
-		dy = (y[i] < 16) ? y[i]+1 : 8;
-		if (y[i]+dy >= height) dy = height - y[i];
-		s = &((short *)wipe_scr_end)[i*height+y[i]];
-		d = &((short *)wipe_scr)[y[i]*width+i];
-		idx = 0;
-		for (j=dy;j;j--)
-		{
-		    d[idx] = *(s++);
-		    idx += width;
-		}
-		y[i] += dy;
-		s = &((short *)wipe_scr_start)[i*height];
-		d = &((short *)wipe_scr)[y[i]*width+i];
-		idx = 0;
-		for (j=height-y[i];j;j--)
-		{
-		    d[idx] = *(s++);
-		    idx += width;
-		}
+		dy = (melt_y[i] < 16) ? melt_y[i]+1 : 8;
+		if (melt_y[i]+dy >= height) dy = height - melt_y[i];
+		melt_y[i] += dy;
 		done = false;
 	    }
 	}
     }
 
+    wipe_composeMelt(width*2, height);
+
     return done;
 
 }
@@ -221,12 +274,30 @@ wipe_exitMelt
   int	height,
   int	ticks )
 {
-    Z_Free(y);
-    Z_Free(wipe_scr_start);
-    Z_Free(wipe_scr_end);
+    // a composed melt has ended on the whole end screen
+    melting = false;
+    if (wipe_scr_meltend != NULL)
+    {
+	Z_Free(wipe_scr_meltend);
+	wipe_scr_meltend = NULL;
+    }
     return 0;
 }
 
+const int *wipe_MeltOffsets (void)
+{
+#ifndef SCREENDIRECT
+    if (wipe_scr_meltend != NULL)
+	return NULL;
+#endif
+    return melting ? melt_y : NULL;
+}
+
+pixel_t *wipe_MeltScreen (void)
+{
+    return wipe_scr_start;
+}
+
 int
 wipe_StartScreen
 ( int	x,
@@ -234,7 +305,8 @@ wipe_StartScreen
   int	width,
   int	height )
 {
-    wipe_scr_start = Z_Malloc(SCREENWIDTH * SCREENHEIGHT, PU_STATIC, NULL);
+    if (wipe_scr_start == NULL)
+	wipe_scr_start = Z_Malloc(SCREENWIDTH * SCREENHEIGHT * sizeof(pixel_t), PU_STATIC, NULL);
     I_ReadScreen(wipe_scr_start);
     return 0;
 }
@@ -246,9 +318,8 @@ wipe_EndScreen
   int	width,
   int	height )
 {
-    wipe_scr_end = Z_Malloc(SCREENWIDTH * SCREENHEIGHT, PU_STATIC, NULL);
-    I_ReadScreen(wipe_scr_end);
-    V_DrawBlock(x, y, width, height, wipe_scr_start); // restore start scr.
+    // the end screen is left in I_VideoBuffer, the wipes
+    // read it from there
     return 0;
 }
 
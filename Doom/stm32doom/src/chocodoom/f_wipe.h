@@ -20,6 +20,9 @@
 #ifndef __F_WIPE_H__
 #define __F_WIPE_H__
 
+#include "doomtype.h"
+#include "i_video.h"
+
 //
 //                       SCREEN WIPE PACKAGE
 //
@@ -60,4 +63,15 @@ wipe_ScreenWipe
   int		height,
   int		ticks );
 
+// While a melt is in progress, the per-column (two pixels wide)
+// offsets of the start screen, otherwise NULL.
+// I_FinishUpdate composes the melt from these, the start screen
+// (wipe_MeltScreen) and the end screen in I_VideoBuffer.
+// With SCREENDIRECT, or while the menu is up, the wipe composes
+// the melt into I_VideoBuffer itself and this is NULL.
+
+const int *wipe_MeltOffsets (void);
+
+pixel_t *wipe_MeltScreen (void);
+
 #endif
@@ -1509,11 +1509,11 @@ void G_DoWorldDone (void)
 extern boolean setsizeneeded;
 void R_ExecuteSetViewSize (void);
 
-char	savename[256];
+static int	loadgameslot;
 
-void G_LoadGame (char* name) 
+void G_LoadGame (int slot) 
 { 
-    M_StringCopy(savename, name, sizeof(savename));
+    loadgameslot = slot;
     gameaction = ga_loadgame; 
 } 
  
@@ -1526,7 +1526,7 @@ void G_DoLoadGame (void)
 	 
     gameaction = ga_nothing; 
 	 
-    if (f_open (&save_stream, savename, FA_OPEN_EXISTING | FA_READ) != FR_OK)
+    if (!P_OpenSaveGameRead (loadgameslot))
     {
     	return;
     }
@@ -1535,7 +1535,7 @@ void G_DoLoadGame (void)
 
     if (!P_ReadSaveGameHeader())
     {
-        f_close (&save_stream);
+        P_CloseSaveGameRead ();
         return;
     }
 
@@ -1555,7 +1555,7 @@ void G_DoLoadGame (void)
     if (!P_ReadSaveGameEOF())
 	I_Error ("Bad savegame");
 
-    f_close (&save_stream);
+    P_CloseSaveGameRead ();
     
     if (setsizeneeded)
     	R_ExecuteSetViewSize ();
@@ -1582,22 +1582,14 @@ G_SaveGame
 
 void G_DoSaveGame (void) 
 { 
-    char *savegame_file;
-    char *temp_savegame_file;
-    FRESULT res;
+    boolean saved;
 
-    temp_savegame_file = (char*)strupr (P_TempSaveGameFile());
-    savegame_file = (char*)strupr (P_SaveGameFile(savegameslot));
+    // The savegame is written to memory, and only stored in its slot
+    // once it has been successfully written. This prevents an existing
+    // savegame from being overwritten by a corrupted one, or if a
+    // savegame buffer overrun occurs.
 
-    // Open the savegame file for writing.  We write to a temporary file
-    // and then rename it at the end if it was successfully written.
-    // This prevents an existing savegame from being overwritten by 
-    // a corrupted one, or if a savegame buffer overrun occurs.
-
-    if (f_open (&save_stream, temp_savegame_file, FA_CREATE_ALWAYS | FA_WRITE) != FR_OK)
-    {
-    	I_Error ("open err %s\n", temp_savegame_file);
-    }
+    P_OpenSaveGameWrite ();
 
     savegame_error = false;
 
@@ -1613,34 +1605,19 @@ void G_DoSaveGame (void)
     // Enforce the same savegame size limit as in Vanilla Doom, 
     // except if the vanilla_savegame_limit setting is turned off.
 
-    if (vanilla_savegame_limit && f_tell (&save_stream) > SAVEGAMESIZE)
+    if (vanilla_savegame_limit && mem_ftell (save_stream) > SAVEGAMESIZE)
     {
         I_Error ("Savegame buffer overrun");
     }
     
-    // Finish up, close the savegame file.
+    // Compress the savegame into its slot.
 
-    f_close (&save_stream);
+    saved = P_CloseSaveGameWrite (savegameslot);
 
-    // Now rename the temporary savegame file to the actual savegame
-    // file, overwriting the old savegame if there was one there.
-
-    if (M_FileExists (savegame_file))
-    {
-    	f_unlink (savegame_file);
-    }
-
-    res = f_rename (temp_savegame_file, savegame_file);
-
-    if (res != FR_OK)
-    {
-    	I_Error ("Savegame not renamed, res = %i", res);
-    }
-    
     gameaction = ga_nothing;
     M_StringCopy(savedescription, "", sizeof(savedescription));
 
-    players[consoleplayer].message = DEH_String(GGSAVED);
+    players[consoleplayer].message = DEH_String(saved ? GGSAVED : GGNOTSAVED);
 
     // draw the pattern into the back screen
     R_FillBackScreen ();	
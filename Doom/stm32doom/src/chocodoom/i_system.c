@@ -17,6 +17,7 @@
 
 
 
+#include <stddef.h>
 #include <stdlib.h>
 #include <stdio.h>
 #include <string.h>
@@ -37,6 +38,7 @@
 #include "config.h"
 
 #include "deh_str.h"
+#include "doomfeatures.h"
 #include "doomtype.h"
 #include "m_argv.h"
 #include "m_config.h"
@@ -60,6 +62,11 @@
 #define DEFAULT_RAM 6 /* MiB */
 #define MIN_RAM     6  /* MiB */
 
+#ifdef FEATURE_ZONE_FROM_SDRAM
+#define SDRAM_HEAP_RESERVE (256 * 1024) /* bytes left for malloc users */
+#define SDRAM_ZONE_STEP    (64 * 1024)  /* bytes */
+#endif
+
 
 typedef struct atexit_listentry_s atexit_listentry_t;
 
@@ -132,6 +139,50 @@ static byte *AutoAllocMemory(int *size, int default_ram, int min_ram)
     return zonemem;
 }
 
+#ifdef FEATURE_ZONE_FROM_SDRAM
+
+// Zone memory allocation function that sizes the zone from the SDRAM
+// left between the current heap break and the end of the heap region
+// (_esdram, just below the reserved WAD region), keeping a small
+// reserve back for the other malloc users.
+
+static byte *SdramAllocMemory(int *size, int min_ram)
+{
+    extern byte _esdram;                        // from the linker script
+    extern void *_sbrk(ptrdiff_t incr);
+    byte *zonemem;
+    byte *heapend;
+
+    heapend = (byte *) _sbrk(0);
+
+    *size = (int) (&_esdram - heapend) - SDRAM_HEAP_RESERVE;
+    *size &= ~(SDRAM_ZONE_STEP - 1);
+
+    zonemem = NULL;
+
+    while (zonemem == NULL)
+    {
+        if (*size < min_ram * 1024 * 1024)
+        {
+            I_Error("Unable to allocate %i MiB of RAM for zone", min_ram);
+        }
+
+        zonemem = malloc(*size);
+
+        // The malloc bookkeeping needs a little room of its own,
+        // so back off in small steps until it fits.
+
+        if (zonemem == NULL)
+        {
+            *size -= SDRAM_ZONE_STEP;
+        }
+    }
+
+    return zonemem;
+}
+
+#endif
+
 byte *I_ZoneBase (int *size)
 {
     byte *zonemem;
@@ -157,7 +208,20 @@ byte *I_ZoneBase (int *size)
         min_ram = MIN_RAM;
     }
 
+#ifdef FEATURE_ZONE_FROM_SDRAM
+    // Without an explicit -mb, take whatever SDRAM is left.
+
+    if (p > 0)
+    {
+        zonemem = AutoAllocMemory(size, default_ram, min_ram);
+    }
+    else
+    {
+        zonemem = SdramAllocMemory(size, min_ram);
+    }
+#else
     zonemem = AutoAllocMemory(size, default_ram, min_ram);
+#endif
 
 //    printf("zone memory: %p, %x allocated for zone\n",
 //           zonemem, *size);
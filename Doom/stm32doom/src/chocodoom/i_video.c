@@ -28,11 +28,15 @@ static const char
 rcsid[] = "$Id: i_x.c,v 1.6 1997/02/03 22:45:10 b1 Exp $";
 
 #include "config.h"
+#include "deh_str.h"
+#include "f_wipe.h"
 #include "v_video.h"
 #include "m_argv.h"
 #include "d_event.h"
 #include "d_main.h"
 #include "i_video.h"
+#include "r_data.h"
+#include "w_wad.h"
 #include "z_zone.h"
 
 #include "tables.h"
@@ -40,10 +44,25 @@ rcsid[] = "$Id: i_x.c,v 1.6 1997/02/03 22:45:10 b1 Exp $";
 
 #include <stdint.h>
 #include <stdbool.h>
+#include <stdio.h>
+#include <string.h>
 #include "mylcd.h"
 
 #include "IJoystick.h"
 
+// Packing helpers for the screen present, using the Cortex-M4 SIMD
+// instructions when available, and a plain C equivalent otherwise.
+#if defined(__ARM_FEATURE_DSP) && (__ARM_FEATURE_DSP == 1)
+#include "cmsis_compiler.h"
+#define UNPACK_EVEN(w)	__UXTB16 (w)			// bytes 0 and 2
+#define UNPACK_ODD(w)	__UXTB16 (__ROR (w, 8))	// bytes 1 and 3
+#define PACK_PIXELS(lo, hi)	__PKHBT (lo, hi, 16)
+#else
+#define UNPACK_EVEN(w)	((w) & 0x00ff00ff)
+#define UNPACK_ODD(w)	(((w) >> 8) & 0x00ff00ff)
+#define PACK_PIXELS(lo, hi)	((uint32_t) (lo) | ((uint32_t) (hi) << 16))
+#endif
+
 
 extern boolean menuactive; // Menu overlayed?
 extern boolean messageNeedsInput; // true when user is prompted for selecting yes/no
@@ -53,7 +72,7 @@ extern boolean M_IsStartControlPanel (void); // returns true if the start menu i
 
 // The screen buffer; this is modified to draw things to the screen
 
-byte *I_VideoBuffer = NULL;
+pixel_t *I_VideoBuffer = NULL;
 
 // If true, game is running as a screensaver
 
@@ -96,22 +115,68 @@ typedef struct
 	byte b;
 } col_t;
 
-// Palette converted to RGB565
+// Number of gamma correction levels (gammatable)
+
+#define NUMGAMMALEVELS 5
+
+// Bank of all PLAYPAL palettes converted to RGB565 at every gamma level,
+// [gamma][palette][256], so that changing either is a pointer swap
+
+static uint16_t* rgb565_bank = NULL;
+static int rgb565_bank_palettes;
+static int playpal_lump;
+
+static void I_InitPaletteBank (void);
+
+// Palette converted to RGB565, for palettes not in the bank
+
+static uint16_t rgb565_scratch[256];
+
+// The active RGB565 palette
+
+const uint16_t* rgb565_palette = rgb565_scratch;
+
+#ifndef SCREENDIRECT
+
+// The screen as last presented, to find the tiles that really changed;
+// not valid after a frame that was not compared, or a palette change
+
+static byte* presented = NULL;
+static boolean presentedvalid = false;
 
-static uint16_t rgb565_palette[256];
+#endif
 
 
 
 void I_InitGraphics (void)
 {
+	// built here, while it can hold PLAYPAL as long as it needs to
+	I_InitPaletteBank ();
+
+#ifdef FEATURE_RGB565_VIDEO
+	// draw straight into the LCD frame buffer, it has the same layout;
+	// the screen is drawn incrementally, so it has to stay the same buffer
+	lcd_set_double_buffered (false);
+	I_VideoBuffer = (pixel_t*)lcd_get_frame_buffer();
+#elif defined(FEATURE_CLUT_VIDEO)
+	// handed to the LCD as it is, the DMA2D converts it through the CLUT
 	I_VideoBuffer = (byte*)Z_Malloc (SCREENWIDTH * SCREENHEIGHT, PU_STATIC, NULL);
+#else
+	I_VideoBuffer = (byte*)Z_Malloc (SCREENWIDTH * SCREENHEIGHT, PU_STATIC, NULL);
+	presented = (byte*)Z_Malloc (SCREENWIDTH * SCREENHEIGHT, PU_STATIC, NULL);
+#endif
 
 	screenvisible = true;
 }
 
 void I_ShutdownGraphics (void)
 {
+#ifndef FEATURE_RGB565_VIDEO
 	Z_Free (I_VideoBuffer);
+#endif
+#ifndef SCREENDIRECT
+	Z_Free (presented);
+#endif
 }
 
 void I_StartFrame (void)
@@ -258,53 +323,493 @@ void I_UpdateNoBlit (void)
 {
 }
 
+#if LCD_MAX_Y != SCREENWIDTH
+#error "The LCD frame buffer requires a row per screen column"
+#endif
+
+#ifdef FEATURE_COLUMN_MAJOR_VIDEO
+#if LCD_MAX_X != SCREENHEIGHT
+#error "The column major screen layout requires LCD columns of SCREENHEIGHT pixels"
+#endif
+#endif
+
+#ifdef FEATURE_RGB565_VIDEO
+
 void I_FinishUpdate (void)
+{
+	// the screen has been drawn straight into the LCD frame buffer,
+	// which must not be drawn into again until it has been transferred
+	lcd_refresh ();
+}
+
+void I_WaitUpdate (void)
+{
+	lcd_sync ();
+}
+
+#elif defined(FEATURE_CLUT_VIDEO)
+
+void I_FinishUpdate (void)
+{
+	// the DMA2D converts the screen through the CLUT on its way to the
+	// LCD, so it must not be drawn into again until it has been transferred
+	lcd_refresh_indexed (I_VideoBuffer);
+}
+
+void I_WaitUpdate (void)
+{
+	lcd_sync ();
+}
+
+#else
+
+//
+// I_FinishMelt
+// Composes columns x0 to x1 of a melt in progress: each column shows
+// the top rows of the end screen (I_VideoBuffer) followed by the start
+// screen, pushed down by the column's melt offset.
+//
+static void I_FinishMelt (uint16_t* pLcdFrameBuffer, const byte* start, const int* offsets,
+                          int x0, int x1)
+{
+	int x, y, dy;
+	const byte* src;
+	uint16_t* dest;
+	const uint16_t* palette = rgb565_palette;
+
+	for (x = x0; x < x1; x++)
+	{
+		dy = offsets[x >> 1];
+
+		if (dy < 0)
+			dy = 0;
+		else if (dy > SCREENHEIGHT)
+			dy = SCREENHEIGHT;
+
+		// a screen column is a single, bottom up, row on the LCD
+		dest = &pLcdFrameBuffer[x * LCD_MAX_X + (LCD_MAX_X - 1)];
+
+		src = &I_VideoBuffer[SCREENOFFSET(x, 0)];
+		for (y = 0; y < dy; y++)
+		{
+			*dest-- = palette[*src];
+			src += SCREENPITCH_Y;
+		}
+
+		src = &start[SCREENOFFSET(x, 0)];
+		for (; y < SCREENHEIGHT; y++)
+		{
+			*dest-- = palette[*src];
+			src += SCREENPITCH_Y;
+		}
+	}
+}
+
+#ifdef FEATURE_COLUMN_MAJOR_VIDEO
+
+//
+// I_FinishRect
+// Converts the screen rectangle (x0, y0) to (x1, y1), exclusive; the
+// screen is already laid out like the LCD frame buffer.
+//
+static void I_FinishRect (uint16_t* pLcdFrameBuffer, int x0, int y0, int x1, int y1)
+{
+	int x, i, end;
+	const uint16_t* palette = rgb565_palette;
+
+	for (x = x0; x < x1; x++)
+	{
+		// columns are contiguous, from the bottom up
+		end = SCREENOFFSET(x, y0);
+
+		for (i = SCREENOFFSET(x, y1 - 1); i <= end; i++)
+		{
+			pLcdFrameBuffer[i] = palette[I_VideoBuffer[i]];
+		}
+	}
+}
+
+#else
+
+#if (DIRTYTILEWIDTH % 4) || (DIRTYTILEHEIGHT % 4) || (LCD_MAX_X % 2)
+#error "The screen present works on 4x4 pixel tiles"
+#endif
+
+//
+// I_FinishRect
+// Converts the screen rectangle (x0, y0) to (x1, y1), exclusive, from
+// the row major screen to the rotated LCD in 4x4 pixel tiles.
+// Each of the four rows of a tile is read a word (four pixels) at a
+// time, and each screen column of the tile is written bottom up as two
+// words, two RGB565 pixels each, along an LCD row.
+//
+static void I_FinishRect (uint16_t* pLcdFrameBuffer, int x0, int y0, int x1, int y1)
 {
 	int x, y;
-	byte index;
-	uint16_t* pLcdFrameBuffer = ( uint16_t* )lcd_get_frame_buffer();
+	const uint32_t* src;
+	uint32_t* dest;
+	uint32_t r0, r1, r2, r3;
+	uint32_t e0, e1, e2, e3;
+	const uint16_t* palette = rgb565_palette;
+
+	for (y = y0; y < y1; y += 4)
+	{
+		src = (const uint32_t*) &I_VideoBuffer[y * SCREENWIDTH + x0];
 
-	for (y = 0; y < SCREENHEIGHT; y++)
+		// the bottom row of the tile is the first pixel on the LCD
+		dest = (uint32_t*) &pLcdFrameBuffer[x0 * LCD_MAX_X + LCD_MAX_X - 4 - y];
+
+		for (x = x0; x < x1; x += 4)
+		{
+			r0 = src[0];
+			r1 = src[SCREENWIDTH / 4];
+			r2 = src[2 * SCREENWIDTH / 4];
+			r3 = src[3 * SCREENWIDTH / 4];
+			src++;
+
+			// columns 0 and 2 of the tile
+			e0 = UNPACK_EVEN (r0);
+			e1 = UNPACK_EVEN (r1);
+			e2 = UNPACK_EVEN (r2);
+			e3 = UNPACK_EVEN (r3);
+
+			dest[0] = PACK_PIXELS (palette[e3 & 0xffff], palette[e2 & 0xffff]);
+			dest[1] = PACK_PIXELS (palette[e1 & 0xffff], palette[e0 & 0xffff]);
+			dest[LCD_MAX_X] = PACK_PIXELS (palette[e3 >> 16], palette[e2 >> 16]);
+			dest[LCD_MAX_X + 1] = PACK_PIXELS (palette[e1 >> 16], palette[e0 >> 16]);
+
+			// columns 1 and 3 of the tile
+			e0 = UNPACK_ODD (r0);
+			e1 = UNPACK_ODD (r1);
+			e2 = UNPACK_ODD (r2);
+			e3 = UNPACK_ODD (r3);
+
+			dest[LCD_MAX_X / 2] = PACK_PIXELS (palette[e3 & 0xffff], palette[e2 & 0xffff]);
+			dest[LCD_MAX_X / 2 + 1] = PACK_PIXELS (palette[e1 & 0xffff], palette[e0 & 0xffff]);
+			dest[3 * LCD_MAX_X / 2] = PACK_PIXELS (palette[e3 >> 16], palette[e2 >> 16]);
+			dest[3 * LCD_MAX_X / 2 + 1] = PACK_PIXELS (palette[e1 >> 16], palette[e0 >> 16]);
+
+			// four LCD rows further
+			dest += 2 * LCD_MAX_X;
+		}
+	}
+}
+
+#endif
+
+#if (LCD_BAND_ROWS % DIRTYTILEWIDTH) || (SCREENHEIGHT % DIRTYTILEHEIGHT) || (DIRTYTILEROWS > 32)
+#error "The LCD bands must be made of whole tile columns"
+#endif
+
+#define ALLTILEROWS (((uint32_t) 2 << (DIRTYTILEROWS - 1)) - 1)
+
+//
+// I_UpdateTiles
+// Compares the marked tiles of a tile column with the presented
+// screen, and copies those that changed over.
+// Returns the tile rows that changed.
+//
+static uint32_t I_UpdateTiles (int tx, uint32_t rows)
+{
+	int ty, i, offset;
+	uint32_t changed = 0;
+
+	for (ty = 0; rows != 0; ty++, rows >>= 1)
 	{
-		for (x = 0; x < SCREENWIDTH; x++)
+		if (!(rows & 1))
+			continue;
+
+#ifdef FEATURE_COLUMN_MAJOR_VIDEO
+		// tile columns are contiguous, from the bottom up
+		for (i = 0; i < DIRTYTILEWIDTH; i++)
+		{
+			offset = SCREENOFFSET(tx * DIRTYTILEWIDTH + i, (ty + 1) * DIRTYTILEHEIGHT - 1);
+
+			if (memcmp (&presented[offset], &I_VideoBuffer[offset], DIRTYTILEHEIGHT))
+			{
+				memcpy (&presented[offset], &I_VideoBuffer[offset], DIRTYTILEHEIGHT);
+				changed |= 1u << ty;
+			}
+		}
+#else
+		for (i = 0; i < DIRTYTILEHEIGHT; i++)
 		{
-			index = I_VideoBuffer[y * SCREENWIDTH + x];
+			offset = SCREENOFFSET(tx * DIRTYTILEWIDTH, ty * DIRTYTILEHEIGHT + i);
 
-			pLcdFrameBuffer[x * LCD_MAX_X + (LCD_MAX_X - y - 1)] = rgb565_palette[index];
+			if (memcmp (&presented[offset], &I_VideoBuffer[offset], DIRTYTILEWIDTH))
+			{
+				memcpy (&presented[offset], &I_VideoBuffer[offset], DIRTYTILEWIDTH);
+				changed |= 1u << ty;
+			}
 		}
+#endif
 	}
 
-	lcd_refresh ();
+	return changed;
+}
+
+void I_FinishUpdate (void)
+{
+	// what the last presented frame changed, and the LCD buffer it went
+	// into: with double buffering, the other buffer still lacks it
+	static uint32_t lastchanged[DIRTYTILECOLS];
+	static boolean lastfull = false;
+	static uint16_t* lastbuffer = NULL;
+
+	int band, tx, ty, ty1, x0, x1;
+	uint32_t rows;
+	uint32_t changed[DIRTYTILECOLS];
+	uint32_t convert[DIRTYTILECOLS];
+	boolean full, allchanged, otherbuffer, refreshed;
+	uint16_t* pLcdFrameBuffer = ( uint16_t* )lcd_get_frame_buffer();
+	const int* meltoffsets = wipe_MeltOffsets ();
+	const byte* meltstart = meltoffsets != NULL ? wipe_MeltScreen () : NULL;
+
+	// the 3D view and the melt change every frame, so are not worth
+	// comparing with the presented screen; other screens often are the
+	// same, even if they are drawn again
+	allchanged = meltoffsets != NULL || dirtyscreen || !presentedvalid;
+	otherbuffer = pLcdFrameBuffer != lastbuffer;
+	full = allchanged || (otherbuffer && lastfull);
+
+	for (tx = 0; tx < DIRTYTILECOLS; tx++)
+	{
+		changed[tx] = allchanged ? ALLTILEROWS : I_UpdateTiles (tx, dirtytiles[tx]);
+		convert[tx] = full ? ALLTILEROWS : changed[tx] | (otherbuffer ? lastchanged[tx] : 0);
+		dirtytiles[tx] = 0;
+	}
+
+	if (meltoffsets != NULL || dirtyscreen)
+	{
+		presentedvalid = false;
+	}
+	else if (allchanged)
+	{
+		memcpy (presented, I_VideoBuffer, SCREENWIDTH * SCREENHEIGHT);
+		presentedvalid = true;
+	}
+	dirtyscreen = false;
+
+	// convert the screen in bands of LCD rows (screen columns), each
+	// band is transferred to the LCD while the next one is converted;
+	// bands without changes are neither converted nor transferred
+	refreshed = false;
+
+	for (band = 0; band < LCD_REFRESH_BANDS; band++)
+	{
+		x0 = band * LCD_BAND_ROWS;
+		x1 = x0 + LCD_BAND_ROWS;
+
+		rows = 0;
+		for (tx = x0 / DIRTYTILEWIDTH; tx < x1 / DIRTYTILEWIDTH; tx++)
+			rows |= convert[tx];
+
+		if (rows == 0)
+			continue;
+
+		lcd_sync_band (band);
+
+		if (meltoffsets != NULL)
+		{
+			I_FinishMelt (pLcdFrameBuffer, meltstart, meltoffsets, x0, x1);
+		}
+		else if (full)
+		{
+			I_FinishRect (pLcdFrameBuffer, x0, 0, x1, SCREENHEIGHT);
+		}
+		else
+		{
+			for (tx = x0 / DIRTYTILEWIDTH; tx < x1 / DIRTYTILEWIDTH; tx++)
+			{
+				// convert each run of changed tiles at once
+				for (ty = 0, rows = convert[tx]; rows != 0; )
+				{
+					for (; !(rows & 1); rows >>= 1)
+						ty++;
+					for (ty1 = ty; rows & 1; rows >>= 1)
+						ty1++;
+
+					I_FinishRect (pLcdFrameBuffer,
+					              tx * DIRTYTILEWIDTH, ty * DIRTYTILEHEIGHT,
+					              (tx + 1) * DIRTYTILEWIDTH, ty1 * DIRTYTILEHEIGHT);
+					ty = ty1;
+				}
+			}
+		}
+
+		lcd_refresh_band (band);
+		refreshed = true;
+	}
+
+	lcd_refresh_end ();
+
+	if (refreshed)
+	{
+		memcpy (lastchanged, changed, sizeof(lastchanged));
+		lastfull = allchanged;
+		lastbuffer = pLcdFrameBuffer;
+	}
+}
+
+void I_WaitUpdate (void)
+{
+	// the screen is converted into the LCD buffers, which
+	// I_FinishUpdate waits for band by band
+}
+
+#endif
+
+//
+// I_DumpPresentStats
+//
+void I_DumpPresentStats (void)
+{
+	tLcdPresentStats stats;
+
+	lcd_get_present_stats (&stats);
+
+	printf ("lcd vblanks: %lu  frames: %lu  missed: %lu  max interval: %lu\n",
+	        (unsigned long)stats.vblanks, (unsigned long)stats.frames,
+	        (unsigned long)stats.missed, (unsigned long)stats.maxInterval);
 }
 
 //
 // I_ReadScreen
 //
-void I_ReadScreen (byte* scr)
+void I_ReadScreen (pixel_t* scr)
 {
-    memcpy (scr, I_VideoBuffer, SCREENWIDTH * SCREENHEIGHT);
+    memcpy (scr, I_VideoBuffer, SCREENWIDTH * SCREENHEIGHT * sizeof(*scr));
 }
 
 //
-// I_SetPalette
+// I_ConvertPalette
+// Converts a palette to RGB565 at a gamma correction level.
 //
-void I_SetPalette (byte* palette)
+static void I_ConvertPalette (uint16_t* dest, const byte* palette, int gamma)
 {
 	int i;
-	col_t* c;
+	const col_t* c;
 
 	for (i = 0; i < 256; i++)
 	{
-		c = (col_t*)palette;
+		c = (const col_t*)palette;
 
-		rgb565_palette[i] = LCD_RGB565(gammatable[usegamma][c->r],
-									   gammatable[usegamma][c->g],
-									   gammatable[usegamma][c->b]);
+		dest[i] = LCD_RGB565(gammatable[gamma][c->r],
+							 gammatable[gamma][c->g],
+							 gammatable[gamma][c->b]);
 
 		palette += 3;
 	}
 }
 
+#ifdef FEATURE_CLUT_VIDEO
+
+//
+// I_SetCLUT
+// Loads a palette, gamma corrected, into the CLUT that the DMA2D
+// converts the screen through. The DMA2D truncates the colors to
+// RGB565 just like LCD_RGB565, so the LCD shows the same pixels.
+//
+static void I_SetCLUT (const byte* palette)
+{
+	static uint32_t clut[256];
+	int i;
+	const col_t* c;
+
+	for (i = 0; i < 256; i++)
+	{
+		c = (const col_t*)palette;
+
+		clut[i] = 0xff000000u
+				| (uint32_t)gammatable[usegamma][c->r] << 16
+				| (uint32_t)gammatable[usegamma][c->g] << 8
+				| (uint32_t)gammatable[usegamma][c->b];
+
+		palette += 3;
+	}
+
+	lcd_set_clut (clut);
+}
+
+#endif
+
+//
+// I_InitPaletteBank
+// Converts all PLAYPAL palettes at all gamma levels, once.
+//
+static void I_InitPaletteBank (void)
+{
+	byte* playpal;
+	int gamma, palnum;
+
+	playpal_lump = W_GetNumForName (DEH_String("PLAYPAL"));
+	rgb565_bank_palettes = W_LumpLength (playpal_lump) / 768;
+
+	rgb565_bank = Z_Malloc (NUMGAMMALEVELS * rgb565_bank_palettes * 256 * sizeof(*rgb565_bank),
+							PU_STATIC, NULL);
+
+	playpal = W_CacheLumpNum (playpal_lump, PU_STATIC);
+
+	for (gamma = 0; gamma < NUMGAMMALEVELS; gamma++)
+	{
+		for (palnum = 0; palnum < rgb565_bank_palettes; palnum++)
+		{
+			I_ConvertPalette ((uint16_t*)I_GetRGB565Palette (palnum, gamma),
+							  playpal + palnum * 768, gamma);
+		}
+	}
+
+	W_ReleaseLumpNum (playpal_lump);
+}
+
+//
+// I_GetRGB565Palette
+//
+const uint16_t* I_GetRGB565Palette (int palnum, int gamma)
+{
+	return &rgb565_bank[(gamma * rgb565_bank_palettes + palnum) * 256];
+}
+
+//
+// I_SetPalette
+//
+void I_SetPalette (byte* palette)
+{
+	byte* playpal = NULL;
+	int palnum;
+
+	// The palettes are always taken from the PLAYPAL lump,
+	// so just pick the matching, already converted, one.
+	// Before I_InitGraphics there is no bank yet: the game
+	// may already have run tics, converting is fine then.
+	if (rgb565_bank != NULL)
+		playpal = W_CacheLumpNum (playpal_lump, PU_CACHE);
+
+	if (playpal != NULL
+	 && palette >= playpal && palette < playpal + rgb565_bank_palettes * 768
+	 && (palette - playpal) % 768 == 0)
+	{
+		palnum = (palette - playpal) / 768;
+		rgb565_palette = I_GetRGB565Palette (palnum, usegamma);
+	}
+	else
+	{
+		I_ConvertPalette (rgb565_scratch, palette, usegamma);
+		rgb565_palette = rgb565_scratch;
+	}
+
+#ifdef FEATURE_RGB565_VIDEO
+	// the screen is drawn with pixels, through the colormaps
+	R_SetColormapPalette (rgb565_palette);
+#elif defined(FEATURE_CLUT_VIDEO)
+	// the screen is converted through the CLUT on its way to the LCD
+	I_SetCLUT (palette);
+#else
+	// every pixel on the LCD changes
+	presentedvalid = false;
+#endif
+}
+
 // Given an RGB value, find the closest matching palette index.
 
 int I_GetPaletteIndex (int r, int g, int b)
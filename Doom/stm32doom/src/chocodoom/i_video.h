@@ -20,13 +20,83 @@
 #ifndef __I_VIDEO__
 #define __I_VIDEO__
 
+#include <stdint.h>
+
 #include "doomtype.h"
+#include "doomfeatures.h"
 
 // Screen width and height.
 
 #define SCREENWIDTH  320
 #define SCREENHEIGHT 200
 
+// Layout of I_VideoBuffer, and of all other screen sized buffers.
+// SCREENOFFSET gives the offset of pixel (x, y), SCREENPITCH_X and
+// SCREENPITCH_Y the distance to the next pixel to the right and below.
+
+#ifdef FEATURE_COLUMN_MAJOR_VIDEO
+
+// Column by column, each column from the bottom up: the order of the
+// (rotated) LCD frame buffer, so the drawn columns are sequential and
+// the screen converts as a single stream.
+
+#define SCREENPITCH_X  SCREENHEIGHT
+#define SCREENPITCH_Y  (-1)
+#define SCREENOFFSET(x, y) ((x) * SCREENHEIGHT + (SCREENHEIGHT - 1 - (y)))
+
+#else
+
+// Row by row, each row from left to right.
+
+#define SCREENPITCH_X  1
+#define SCREENPITCH_Y  SCREENWIDTH
+#define SCREENOFFSET(x, y) ((y) * SCREENWIDTH + (x))
+
+#endif
+
+// Pixels of I_VideoBuffer and the other screen buffers.
+// I_PIXEL converts a palette index to a pixel.
+
+#ifdef FEATURE_RGB565_VIDEO
+
+#ifndef FEATURE_COLUMN_MAJOR_VIDEO
+#error "FEATURE_RGB565_VIDEO requires FEATURE_COLUMN_MAJOR_VIDEO"
+#endif
+
+#ifdef FEATURE_CLUT_VIDEO
+#error "FEATURE_CLUT_VIDEO excludes FEATURE_RGB565_VIDEO"
+#endif
+
+// RGB565, of the palette that was active when drawn.
+
+typedef uint16_t pixel_t;
+
+#define I_PIXEL(index) (rgb565_palette[index])
+
+#else
+
+#ifdef FEATURE_CLUT_VIDEO
+#ifndef FEATURE_COLUMN_MAJOR_VIDEO
+#error "FEATURE_CLUT_VIDEO requires FEATURE_COLUMN_MAJOR_VIDEO"
+#endif
+#endif
+
+// Palette indices, converted when the screen is presented.
+
+typedef byte pixel_t;
+
+#define I_PIXEL(index) (index)
+
+#endif
+
+// SCREENDIRECT is defined when I_VideoBuffer goes to the LCD as it is,
+// so that I_FinishUpdate cannot compose anything (such as the melt)
+// into the picture on the way.
+
+#if defined(FEATURE_RGB565_VIDEO) || defined(FEATURE_CLUT_VIDEO)
+#define SCREENDIRECT
+#endif
+
 // Screen width used for "squash" scale functions
 
 #define SCREENWIDTH_4_3 256
@@ -104,10 +174,23 @@ void I_ShutdownGraphics(void);
 void I_SetPalette (byte* palette);
 int I_GetPaletteIndex(int r, int g, int b);
 
+// PLAYPAL palette converted to RGB565 at a gamma level,
+// as used by I_SetPalette; valid after I_InitGraphics.
+const uint16_t* I_GetRGB565Palette (int palnum, int gamma);
+
 void I_UpdateNoBlit (void);
 void I_FinishUpdate (void);
 
-void I_ReadScreen (byte* scr);
+// Waits until the screen passed on by I_FinishUpdate may be drawn
+// into again. Called just before drawing, so that the tics run while
+// the transfer waits for the LCD.
+void I_WaitUpdate (void);
+
+// Reports how the LCD kept up: frames presented, and vertical
+// blankings missed while a frame was still being transferred.
+void I_DumpPresentStats (void);
+
+void I_ReadScreen (pixel_t* scr);
 
 void I_BeginRead (void);
 void I_EndRead (void);
@@ -145,7 +228,10 @@ extern int mouse_threshold;
 extern int vanilla_keyboard_mapping;
 extern boolean screensaver_mode;
 extern int usegamma;
-extern byte *I_VideoBuffer;
+extern pixel_t *I_VideoBuffer;
+
+// The active palette, converted to RGB565.
+extern const uint16_t *rgb565_palette;
 
 extern int screen_width;
 extern int screen_height;
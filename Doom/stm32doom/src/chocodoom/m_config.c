@@ -516,6 +516,22 @@ static default_t	doom_defaults_list[] =
 
     CONFIG_VARIABLE_INT(detaillevel),
 
+    //!
+    // Frame rate held by the frame governor, when it is built in:
+    // the detail and the screen size are lowered from the settings
+    // above when frames take longer. Values below 35 also cap the
+    // frame rate, to save power. Zero turns the governor off.
+    //
+
+    CONFIG_VARIABLE_INT(governor_fps),
+
+    //!
+    // Bytes of composite textures kept for the whole level once
+    // built. Composites beyond it may be purged and built again.
+    //
+
+    CONFIG_VARIABLE_INT(composite_budget),
+
     //!
     // Number of sounds that will be played simultaneously.
     //
@@ -19,26 +19,79 @@
 
 
 #include "stdlib.h"
+#include <stdio.h>
 
 #include "doomtype.h"
 #include "i_system.h"
+#include "i_timer.h"
 
 #include "m_fixed.h"
 
 
 
 
-// Fixme. __USE_C_FIXED__ or something.
+#if defined(__ARM_FEATURE_IDIV) && (__ARM_FEATURE_IDIV == 1)
 
-fixed_t
-FixedMul
-( fixed_t	a,
-  fixed_t	b )
+//
+// FixedDivLong
+// (a << FRACBITS) / b for a <= 2^31 and b >= 2^16, by long division
+//  in 16-bit digits on the normalized divisor, with 32-bit UDIVs
+//  (Knuth's algorithm D, as in Hacker's Delight divlu).
+// The quotient always fits in 32 bits, as a>>16 < b.
+//
+
+uint32_t FixedDivLong(uint32_t a, uint32_t b)
 {
-    return ((int64_t) a * (int64_t) b) >> FRACBITS;
-}
+    uint64_t	n;
+    uint32_t	n32, n21, n10;
+    uint32_t	n1, n0;
+    uint32_t	b1, b0;
+    uint32_t	q1, q0;
+    uint32_t	rhat;
+    int		s;
+
+    // normalize so that the top bit of the divisor is set
+    s = __builtin_clz (b);
+    b <<= s;
+    b1 = b >> 16;
+    b0 = b & 0xffff;
+
+    n = (uint64_t) a << (FRACBITS + s);
+    n32 = (uint32_t) (n >> 32);
+    n10 = (uint32_t) n;
+    n1 = n10 >> 16;
+    n0 = n10 & 0xffff;
+
+    // first quotient digit, the estimate is at most 2 too high
+    q1 = n32 / b1;
+    rhat = n32 - q1 * b1;
+
+    while (q1 >= 0x10000 || q1 * b0 > ((rhat << 16) | n1))
+    {
+	q1--;
+	rhat += b1;
+	if (rhat >= 0x10000)
+	    break;
+    }
+
+    n21 = (n32 << 16) + n1 - q1 * b;
+
+    // second quotient digit
+    q0 = n21 / b1;
+    rhat = n21 - q0 * b1;
 
+    while (q0 >= 0x10000 || q0 * b0 > ((rhat << 16) | n0))
+    {
+	q0--;
+	rhat += b1;
+	if (rhat >= 0x10000)
+	    break;
+    }
 
+    return (q1 << 16) | q0;
+}
+
+#else
 
 //
 // FixedDiv, C version.
@@ -46,6 +99,9 @@ FixedMul
 
 fixed_t FixedDiv(fixed_t a, fixed_t b)
 {
+#ifdef FEATURE_ZONE_STATS
+    fixeddivcalls++;
+#endif
     if ((abs(a) >> 14) >= abs(b))
     {
 	return (a^b) < 0 ? INT_MIN : INT_MAX;
@@ -60,3 +116,103 @@ fixed_t FixedDiv(fixed_t a, fixed_t b)
     }
 }
 
+#endif
+
+
+#ifdef FEATURE_ZONE_STATS
+
+unsigned int	fixedmulcalls;
+unsigned int	fixeddivcalls;
+
+// nanoseconds per call, measured by M_TimeFixed
+static int	fixedmulns;
+static int	fixedmuloldns;
+static int	fixeddivns;
+static int	fixeddivoldns;
+
+static fixed_t FixedMulOld (fixed_t a, fixed_t b)
+{
+    return ((int64_t) a * (int64_t) b) >> FRACBITS;
+}
+
+static fixed_t FixedDivOld (fixed_t a, fixed_t b)
+{
+    if ((abs(a) >> 14) >= abs(b))
+	return (a^b) < 0 ? INT_MIN : INT_MAX;
+
+    return (fixed_t) (((int64_t) a << 16) / b);
+}
+
+// Called through pointers, so that they are not inlined,
+//  like the old FixedMul and FixedDiv in this file.
+static fixed_t (*volatile fixedmulold) (fixed_t, fixed_t) = FixedMulOld;
+static fixed_t (*volatile fixeddivold) (fixed_t, fixed_t) = FixedDivOld;
+
+// operands, of the magnitudes that the renderer sees
+#define TIMEDOPERANDS	256
+
+static fixed_t		timeda[TIMEDOPERANDS];
+static fixed_t		timedb[TIMEDOPERANDS];
+static volatile unsigned int timedsink;
+
+// nanoseconds per call of expr, over passes of all operands
+#define M_TIMECALLS(ns, passes, expr)					\
+{									\
+    int		start = I_GetTimeMS ();					\
+    unsigned int sum = 0;					\
+    int		pass;							\
+    int		i;							\
+									\
+    for (pass = 0; pass < (passes); pass++)				\
+	for (i = 0; i < TIMEDOPERANDS; i++)				\
+	    sum += (unsigned int) (expr);				\
+									\
+    timedsink = sum;							\
+    ns = (int) ((I_GetTimeMS () - start) * 1000000LL			\
+		/ ((passes) * TIMEDOPERANDS));				\
+}
+
+void M_TimeFixed (void)
+{
+    unsigned int	r = 1;
+    int			i;
+
+    for (i = 0; i < TIMEDOPERANDS; i++)
+    {
+	r = r * 1103515245 + 12345;
+	timeda[i] = (fixed_t) r >> (r & 7);
+	r = r * 1103515245 + 12345;
+	timedb[i] = (fixed_t) ((r >> (8 + (r & 7))) | 1);
+    }
+
+    M_TIMECALLS (fixedmulns, 8192, FixedMul (timeda[i], timedb[i]));
+    M_TIMECALLS (fixedmuloldns, 8192, fixedmulold (timeda[i], timedb[i]));
+    M_TIMECALLS (fixeddivns, 1024, FixedDiv (timeda[i], timedb[i]));
+    M_TIMECALLS (fixeddivoldns, 1024, fixeddivold (timeda[i], timedb[i]));
+
+    fixedmulcalls = fixeddivcalls = 0;
+
+    printf ("FixedMul %i ns (was %i ns), FixedDiv %i ns (was %i ns) per call\n",
+	    fixedmulns, fixedmuloldns, fixeddivns, fixeddivoldns);
+}
+
+void M_DumpFixedStats (int frames)
+{
+    int		mulcalls;
+    int		divcalls;
+
+    if (frames <= 0)
+	return;
+
+    mulcalls = fixedmulcalls / frames;
+    divcalls = fixeddivcalls / frames;
+
+    printf ("per frame: FixedMul %i calls, FixedDiv %i calls, %i us saved\n",
+	    mulcalls, divcalls,
+	    (int) (((long long) mulcalls * (fixedmuloldns - fixedmulns)
+		  + (long long) divcalls * (fixeddivoldns - fixeddivns)) / 1000));
+
+    fixedmulcalls = fixeddivcalls = 0;
+}
+
+#endif
@@ -232,8 +232,8 @@ enum
 {
     newgame = 0,
 //  options,  ** disabled as there is nothing to change, really
-//  loadgame, ** disabled as we don't support load/save of games
-//  savegame, ** disabled as we don't support load/save of games
+    loadgame,
+    savegame,
     readthis,
     quitdoom,
     main_end
@@ -243,8 +243,8 @@ menuitem_t MainMenu[]=
 {
     {1,"M_NGAME",M_NewGame,'n'},
 //  {1,"M_OPTION",M_Options,'o'}, ** disabled as there is nothing to change, really
-//  {1,"M_LOADG",M_LoadGame,'l'}, ** disabled as we don't support load/save of games
-//  {1,"M_SAVEG",M_SaveGame,'s'}, ** disabled as we don't support load/save of games
+    {1,"M_LOADG",M_LoadGame,'l'},
+    {1,"M_SAVEG",M_SaveGame,'s'},
     // Another hickup with Special edition.
     {1,"M_RDTHIS",M_ReadThis,'r'},
     {1,"M_QUITG",M_QuitDOOM,'q'}
@@ -502,38 +502,17 @@ menu_t  SaveDef =
 //
 void M_ReadSaveStrings(void)
 {
-#if ORIGCODE
-    FILE   *handle;
-#else
-    FIL		handle;
-    unsigned long count;
-#endif
     int     i;
-    char    name[256];
 
     for (i = 0;i < load_end;i++)
     {
-        M_StringCopy(name, P_SaveGameFile(i), sizeof(name));
-#if ORIGCODE
-        handle = fopen(name, "rb");
-
-        if (handle == NULL)
-#else
-        if (f_open (&handle, name, FA_OPEN_EXISTING | FA_READ) != FR_OK)
-#endif
+        if (!P_ReadSaveGameDescription(i, savegamestrings[i]))
         {
             M_StringCopy(savegamestrings[i], EMPTYSTRING, SAVESTRINGSIZE);
             LoadMenu[i].status = 0;
             continue;
         }
 
-#if ORIGCODE
-		fread(&savegamestrings[i], 1, SAVESTRINGSIZE, handle);
-		fclose(handle);
-#else
-		f_read (&handle, &savegamestrings[i], SAVESTRINGSIZE, &count);
-		f_close (&handle);
-#endif
 		LoadMenu[i].status = 1;
     }
 }
@@ -586,11 +565,7 @@ void M_DrawSaveLoadBorder(int x,int y)
 //
 void M_LoadSelect(int choice)
 {
-    char    name[256];
-	
-    M_StringCopy(name, P_SaveGameFile(choice), sizeof(name));
-
-    G_LoadGame (name);
+    G_LoadGame (choice);
     M_ClearMenus ();
 }
 
@@ -33,59 +33,93 @@
 #include "m_misc.h"
 #include "r_state.h"
 
-#include "ff.h"
+#include "mysave.h"
 
 #define SAVEGAME_EOF 0x1d
 #define VERSIONSIZE 16 
 
-FIL save_stream;
-int savegamelength;
+MEMFILE *save_stream;
 boolean savegame_error;
 
-// Get the filename of a temporary file to write the savegame to.  After
-// the file has been successfully saved, it will be renamed to the 
-// real file.
+// Buffer holding the savegame being loaded
 
-char *P_TempSaveGameFile(void)
+static byte *savegame_buffer = NULL;
+
+// Open the savegame in a slot for reading.  The whole savegame is
+// decompressed into memory at once.
+
+boolean P_OpenSaveGameRead(int slot)
 {
-    static char *filename = NULL;
+    size_t size;
+
+    size = save_slot_size(slot);
+
+    if (size == 0)
+    {
+        return false;
+    }
+
+    savegame_buffer = Z_Malloc(size, PU_STATIC, NULL);
 
-    if (filename == NULL)
+    if (save_slot_read(slot, savegame_buffer, size) != size)
     {
-        filename = M_StringJoin(savegamedir, "temp.dsg", NULL);
+        Z_Free(savegame_buffer);
+        savegame_buffer = NULL;
+        return false;
     }
 
-    return filename;
+    save_stream = mem_fopen_read(savegame_buffer, size);
+
+    return true;
+}
+
+void P_CloseSaveGameRead(void)
+{
+    mem_fclose(save_stream);
+    Z_Free(savegame_buffer);
+    savegame_buffer = NULL;
 }
 
-// Get the filename of the save game file to use for the specified slot.
+// Start writing a new savegame into memory.
 
-char *P_SaveGameFile(int slot)
+void P_OpenSaveGameWrite(void)
 {
-    static char *filename = NULL;
-    static size_t filename_size = 0;
-    char basename[32];
+    save_stream = mem_fopen_write();
+}
 
-    if (filename == NULL)
-    {
-        filename_size = strlen(savegamedir) + 32;
-        filename = malloc(filename_size);
-    }
+// Store the savegame written since P_OpenSaveGameWrite in a slot.
+// The previous savegame in the slot is kept if this fails.
+
+boolean P_CloseSaveGameWrite(int slot)
+{
+    void *buf;
+    size_t buflen;
+    boolean result;
+
+    mem_get_buf(save_stream, &buf, &buflen);
+
+    result = save_slot_write(slot, buf, buflen);
 
-    DEH_snprintf(basename, 32, SAVEGAMENAME "%d.dsg", slot);
-    M_snprintf(filename, filename_size, "%s%s", savegamedir, basename);
+    mem_fclose(save_stream);
 
-    return filename;
+    return result;
+}
+
+// Read the description of the savegame in a slot, which is the
+// first thing in the savegame header.
+
+boolean P_ReadSaveGameDescription(int slot, char *description)
+{
+    return save_slot_read(slot, description, SAVESTRINGSIZE) == SAVESTRINGSIZE;
 }
 
 // Endian-safe integer read/write functions
 
 static byte saveg_read8(void)
 {
-    byte result;
-    unsigned long count;
+    byte result = -1;
 
-    if (f_readn (&save_stream, &result, 1, &count) != FR_OK)
+    if (mem_fread(&result, 1, 1, save_stream) < 1)
     {
         if (!savegame_error)
         {
@@ -101,9 +135,7 @@ static byte saveg_read8(void)
 
 static void saveg_write8(byte value)
 {
-	unsigned long count;
-
-	if (f_writen (&save_stream, &value, 1, &count) != FR_OK)
+    if (mem_fwrite(&value, 1, 1, save_stream) < 1)
     {
         if (!savegame_error)
         {
@@ -158,7 +190,7 @@ static void saveg_read_pad(void)
     int padding;
     int i;
 
-    pos = f_tell (&save_stream);
+    pos = mem_ftell(save_stream);
 
     padding = (4 - (pos & 3)) & 3;
 
@@ -174,7 +206,7 @@ static void saveg_write_pad(void)
     int padding;
     int i;
 
-    pos = f_tell (&save_stream);
+    pos = mem_ftell(save_stream);
 
     padding = (4 - (pos & 3)) & 3;
 
@@ -20,19 +20,24 @@
 #ifndef __P_SAVEG__
 #define __P_SAVEG__
 
-#include "ff.h"
+#include "doomtype.h"
+#include "memio.h"
 
 // maximum size of a savegame description
 
 #define SAVESTRINGSIZE 24
 
-// temporary filename to use while saving.
+// Savegame slot access; savegames are kept in memory while they
+// are read or written, and compressed into the slot storage.
 
-char *P_TempSaveGameFile(void);
+boolean P_OpenSaveGameRead(int slot);
+void P_CloseSaveGameRead(void);
+void P_OpenSaveGameWrite(void);
+boolean P_CloseSaveGameWrite(int slot);
 
-// filename to use for a savegame slot
+// Read the description of the savegame in a slot
 
-char *P_SaveGameFile(int slot);
+boolean P_ReadSaveGameDescription(int slot, char *description);
 
 // Savegame file header read/write functions
 
@@ -55,7 +60,7 @@ void P_UnArchiveThinkers (void);
 void P_ArchiveSpecials (void);
 void P_UnArchiveSpecials (void);
 
-extern FIL save_stream;
+extern MEMFILE *save_stream;
 extern boolean savegame_error;
 
 
@@ -186,6 +186,29 @@ void P_InitPicAnims (void)
 }
 
 
+//
+// P_TextureAnimRange
+// All the frames a wall texture may show during the level.
+//
+void P_TextureAnimRange (int texnum, int* first, int* last)
+{
+    anim_t*	anim;
+
+    for (anim = anims ; anim < lastanim ; anim++)
+    {
+	if (anim->istexture
+	 && texnum >= anim->basepic && texnum <= anim->picnum)
+	{
+	    *first = anim->basepic;
+	    *last = anim->picnum;
+	    return;
+	}
+    }
+
+    *first = *last = texnum;
+}
+
+
 
 //
 // UTILITIES
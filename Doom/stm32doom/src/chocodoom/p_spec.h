@@ -38,6 +38,10 @@ extern	int	levelTimeCount;
 // at game start
 void    P_InitPicAnims (void);
 
+// the frames of the texture animation texnum is in,
+//  first == last == texnum if it is not animated
+void    P_TextureAnimRange (int texnum, int* first, int* last);
+
 // at map load
 void    P_SpawnSpecials (void);
 
@@ -252,6 +256,9 @@ P_ChangeSwitchTexture
 
 void P_InitSwitchList(void);
 
+// the other texture of a switch, -1 if texnum is not a switch
+int P_SwitchPartner(int texnum);
+
 
 //
 // P_PLATS
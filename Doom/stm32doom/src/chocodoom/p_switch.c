@@ -142,6 +142,24 @@ void P_InitSwitchList(void)
 }
 
 
+//
+// P_SwitchPartner
+// The texture a switch texture changes to, and back.
+//
+int P_SwitchPartner(int texnum)
+{
+    int		i;
+
+    for (i = 0;i < numswitches*2;i++)
+    {
+	if (switchlist[i] == texnum)
+	    return switchlist[i^1];
+    }
+
+    return -1;
+}
+
+
 //
 // Start a button counting down till it turns off.
 //
@@ -43,7 +43,9 @@ line_t*		linedef;
 sector_t*	frontsector;
 sector_t*	backsector;
 
-drawseg_t	drawsegs[MAXDRAWSEGS];
+// numdrawsegs are allocated, grown by R_GrowDrawSegs.
+drawseg_t*	drawsegs;
+int		numdrawsegs;
 drawseg_t*	ds_p;
 
 
@@ -64,6 +66,26 @@ void R_ClearDrawSegs (void)
 }
 
 
+//
+// R_GrowDrawSegs
+// Returns false past MAXDRAWSEGS.
+//
+boolean R_GrowDrawSegs (void)
+{
+    drawseg_t*	grown;
+
+    grown = R_GrowLimit (drawsegs, &numdrawsegs, sizeof(*drawsegs),
+			 DRAWSEGCHUNK, MAXDRAWSEGS);
+
+    if (grown == NULL)
+	return false;
+
+    ds_p = grown + (ds_p - drawsegs);
+    drawsegs = grown;
+    return true;
+}
+
+
 
 //
 // ClipWallSegment
@@ -78,7 +100,10 @@ typedef	struct
 } cliprange_t;
 
 
-#define MAXSEGS		32
+// The ranges are kept apart by at least a column, so there can be no
+//  more than half the screen width of them, plus the two sentinels
+//  and one being inserted.
+#define MAXSEGS		(SCREENWIDTH/2+4)
 
 // newend is one past the last valid seg
 cliprange_t*	newend;
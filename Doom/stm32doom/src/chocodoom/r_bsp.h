@@ -39,7 +39,8 @@ extern boolean		markceiling;
 
 extern boolean		skymap;
 
-extern drawseg_t	drawsegs[MAXDRAWSEGS];
+extern drawseg_t*	drawsegs;
+extern int		numdrawsegs;
 extern drawseg_t*	ds_p;
 
 extern lighttable_t**	hscalelight;
@@ -52,6 +53,7 @@ typedef void (*drawfunc_t) (int start, int stop);
 
 // BSP?
 void R_ClearClipSegs (void);
+boolean R_GrowDrawSegs (void);
 void R_ClearDrawSegs (void);
 
 
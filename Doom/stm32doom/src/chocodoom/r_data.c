@@ -151,6 +151,26 @@ short**			texturecolumnlump;
 unsigned short**	texturecolumnofs;
 byte**			texturecomposite;
 
+//
+// COMPOSITE TEXTURE CACHE
+// Composites are prebuilt at level start by R_PrecacheLevel, and
+//  are kept for the whole level (PU_LEVEL) as long as they fit in
+//  composite_budget bytes. Composites beyond the budget are purgable
+//  (PU_CACHE) as in vanilla, and may have to be rebuilt.
+// The budget is the composite_budget config variable.
+//
+#define COMPOSITE_BUDGET	(512 * 1024)
+
+int			composite_budget = COMPOSITE_BUDGET;
+int			compositememory;	// bytes kept this level
+#ifdef FEATURE_ZONE_STATS
+int			composite_hits;
+int			composite_misses;
+int			composite_rebuilds;
+#endif
+
+static byte*		compositebuilt;		// built this level?
+
 // for global animation
 int*		flattranslation;
 int*		texturetranslation;
@@ -233,12 +253,20 @@ void R_GenerateComposite (int texnum)
     int			x1;
     int			x2;
     int			i;
+    int			tag;
     column_t*		patchcol;
     short*		collump;
     unsigned short*	colofs;
 	
     texture = textures[texnum];
 
+#ifdef FEATURE_ZONE_STATS
+    if (compositebuilt[texnum])
+	composite_rebuilds++;
+#endif
+
+    compositebuilt[texnum] = 1;
+
     block = Z_Malloc (texturecompositesize[texnum],
 		      PU_STATIC, 
 		      &texturecomposite[texnum]);	
@@ -282,8 +310,19 @@ void R_GenerateComposite (int texnum)
     }
 
     // Now that the texture has been built in column cache,
-    //  it is purgable from zone memory.
-    Z_ChangeTag (block, PU_CACHE);
+    //  keep it for the level if it fits in the budget,
+    //  otherwise it is purgable from zone memory.
+    if (compositememory + texturecompositesize[texnum] <= composite_budget)
+    {
+	compositememory += texturecompositesize[texnum];
+	tag = PU_LEVEL;
+    }
+    else
+    {
+	tag = PU_CACHE;
+    }
+
+    Z_ChangeTag (block, tag);
 }
 
 
@@ -391,11 +430,29 @@ R_GetColumn
     lump = texturecolumnlump[tex][col];
     ofs = texturecolumnofs[tex][col];
     
+    // Loading a lump or generating a composite may purge the
+    //  sources of queued columns.
     if (lump > 0)
+    {
+	if (lumpinfo[lump].cache == NULL)
+	    R_FlushColumns ();
 	return (byte *)W_CacheLumpNum(lump,PU_CACHE)+ofs;
+    }
 
     if (!texturecomposite[tex])
+    {
+#ifdef FEATURE_ZONE_STATS
+	composite_misses++;
+#endif
+	R_FlushColumns ();
 	R_GenerateComposite (tex);
+    }
+#ifdef FEATURE_ZONE_STATS
+    else
+    {
+	composite_hits++;
+    }
+#endif
 
     return texturecomposite[tex] + ofs;
 }
@@ -524,6 +581,8 @@ void R_InitTextures (void)
     texturecolumnofs = Z_Malloc (numtextures * sizeof(*texturecolumnofs), PU_STATIC, 0);
     texturecomposite = Z_Malloc (numtextures * sizeof(*texturecomposite), PU_STATIC, 0);
     texturecompositesize = Z_Malloc (numtextures * sizeof(*texturecompositesize), PU_STATIC, 0);
+    compositebuilt = Z_Malloc (numtextures, PU_STATIC, 0);
+    memset (compositebuilt, 0, numtextures);
     texturewidthmask = Z_Malloc (numtextures * sizeof(*texturewidthmask), PU_STATIC, 0);
     textureheight = Z_Malloc (numtextures * sizeof(*textureheight), PU_STATIC, 0);
 
@@ -679,6 +738,12 @@ void R_InitSpriteLumps (void)
 
 
 
+#ifdef FEATURE_RGB565_VIDEO
+// The COLORMAP lump, colormaps holds it converted to pixels
+static byte*	colormaps8;
+static int	colormapslength;
+#endif
+
 //
 // R_InitColormaps
 //
@@ -689,8 +754,34 @@ void R_InitColormaps (void)
     // Load in the light tables, 
     //  256 byte align tables.
     lump = W_GetNumForName(DEH_String("COLORMAP"));
+#ifdef FEATURE_RGB565_VIDEO
+    colormaps8 = W_CacheLumpNum(lump, PU_STATIC);
+    colormapslength = W_LumpLength(lump);
+    colormaps = Z_Malloc(colormapslength*sizeof(*colormaps), PU_STATIC, 0);
+    R_SetColormapPalette (rgb565_palette);
+#else
     colormaps = W_CacheLumpNum(lump, PU_STATIC);
+#endif
+}
+
+
+#ifdef FEATURE_RGB565_VIDEO
+//
+// R_SetColormapPalette
+// Converts the light tables to pixels of a new palette.
+//
+void R_SetColormapPalette (const uint16_t* palette)
+{
+    int	i;
+
+    // not loaded yet, done by R_InitColormaps
+    if (colormaps == NULL)
+	return;
+
+    for (i=0 ; i<colormapslength ; i++)
+	colormaps[i] = palette[colormaps8[i]];
 }
+#endif
 
 
 
@@ -789,6 +880,98 @@ int	R_TextureNumForName (char* name)
 
 
 
+//
+// R_PrecacheComposite
+// Builds the composite of a texture for the level, or keeps the
+//  one left from an earlier level for it, within the budget.
+//
+static void R_PrecacheComposite (int texnum)
+{
+    int		size;
+
+    // 0 is "no texture"
+    if (texnum == 0 || compositebuilt[texnum])
+	return;
+
+    size = texturecompositesize[texnum];
+
+    if (!size)
+	return;
+
+    if (!texturecomposite[texnum])
+    {
+	R_GenerateComposite (texnum);
+	return;
+    }
+
+    // survived as PU_CACHE
+    compositebuilt[texnum] = 1;
+
+    if (compositememory + size <= composite_budget)
+    {
+	compositememory += size;
+	Z_ChangeTag (texturecomposite[texnum], PU_LEVEL);
+    }
+}
+
+
+//
+// R_PrecacheWallTexture
+// A wall texture, and all the textures it can change to during
+//  the level: the frames of its animation and its switch partner.
+//
+static void R_PrecacheWallTexture (int texnum)
+{
+    int		first;
+    int		last;
+    int		partner;
+    int		i;
+
+    if (texnum == 0)
+	return;
+
+    P_TextureAnimRange (texnum, &first, &last);
+
+    for (i=first ; i<=last ; i++)
+	R_PrecacheComposite (i);
+
+    partner = P_SwitchPartner (texnum);
+
+    if (partner > 0)
+    {
+	P_TextureAnimRange (partner, &first, &last);
+
+	for (i=first ; i<=last ; i++)
+	    R_PrecacheComposite (i);
+    }
+}
+
+
+//
+// R_PrecacheComposites
+// Builds the composites of all textures on the level's walls,
+//  so that drawing never has to. Also done for demos, as it
+//  does not change the timing of the game.
+//
+static void R_PrecacheComposites (void)
+{
+    int		i;
+
+    // Level composites were released with the PU_LEVEL blocks.
+    compositememory = 0;
+    memset (compositebuilt, 0, numtextures);
+
+    for (i=0 ; i<numsides ; i++)
+    {
+	R_PrecacheWallTexture (sides[i].toptexture);
+	R_PrecacheWallTexture (sides[i].midtexture);
+	R_PrecacheWallTexture (sides[i].bottomtexture);
+    }
+
+    R_PrecacheWallTexture (skytexture);
+}
+
+
 //
 // R_PrecacheLevel
 // Preloads all relevant graphics for the level.
@@ -812,6 +995,8 @@ void R_PrecacheLevel (void)
     thinker_t*		th;
     spriteframe_t*	sf;
 
+    R_PrecacheComposites ();
+
     if (demoplayback)
 	return;
     
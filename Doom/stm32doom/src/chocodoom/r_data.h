@@ -36,6 +36,20 @@ R_GetColumn
 void R_InitData (void);
 void R_PrecacheLevel (void);
 
+#ifdef FEATURE_RGB565_VIDEO
+// Called by I_SetPalette, the colormaps map to RGB565 pixels.
+void R_SetColormapPalette (const uint16_t* palette);
+#endif
+
+// Composite texture cache budget (bytes) and statistics.
+extern int composite_budget;
+extern int compositememory;
+#ifdef FEATURE_ZONE_STATS
+extern int composite_hits;
+extern int composite_misses;
+extern int composite_rebuilds;
+#endif
+
 
 // Retrieval.
 // Floor/ceiling opaque texture tiles,
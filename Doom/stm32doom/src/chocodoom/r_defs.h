@@ -48,7 +48,20 @@
 #define SIL_TOP			2
 #define SIL_BOTH		3
 
-#define MAXDRAWSEGS		256
+//
+// Renderer limits.
+// The visplanes, drawsegs, vissprites and openings of a frame are
+//  zone arrays that grow by a chunk whenever a frame needs more, up
+//  to these caps. What does not fit under a cap is left undrawn.
+//
+#define MAXVISPLANES		512
+#define VISPLANECHUNK		32
+#define MAXDRAWSEGS		1024
+#define DRAWSEGCHUNK		128
+#define MAXVISSPRITES		512
+#define VISSPRITECHUNK		64
+#define MAXOPENINGS		(SCREENWIDTH*256)
+#define OPENINGCHUNK		(SCREENWIDTH*16)
 
 
 
@@ -295,7 +308,9 @@ typedef struct
 //  precalculating 24bpp lightmap/colormap LUT.
 //  from darkening PLAYPAL to all black.
 // Could even us emore than 32 levels.
-typedef byte	lighttable_t;	
+// With FEATURE_RGB565_VIDEO the colormaps map
+//  straight to RGB565 pixels.
+typedef pixel_t	lighttable_t;	
 
 
 
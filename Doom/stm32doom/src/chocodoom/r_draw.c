@@ -24,6 +24,7 @@
 #include "doomdef.h"
 #include "deh_main.h"
 
+#include "i_swap.h"
 #include "i_system.h"
 #include "z_zone.h"
 #include "w_wad.h"
@@ -60,7 +61,7 @@ int		scaledviewwidth;
 int		viewheight;
 int		viewwindowx;
 int		viewwindowy; 
-byte*		ylookup[MAXHEIGHT]; 
+pixel_t*	ylookup[MAXHEIGHT]; 
 int		columnofs[MAXWIDTH]; 
 
 // Color tables for different players,
@@ -72,7 +73,7 @@ byte		translations[3][256];
 // Backing buffer containing the bezel drawn around the screen and 
 // surrounding background.
 
-static byte *background_buffer = NULL;
+static pixel_t *background_buffer = NULL;
 
 
 //
@@ -102,7 +103,7 @@ int			dccount;
 void R_DrawColumn (void) 
 { 
     int			count; 
-    byte*		dest; 
+    pixel_t*		dest; 
     fixed_t		frac;
     fixed_t		fracstep;	 
  
@@ -138,7 +139,7 @@ void R_DrawColumn (void)
 	//  using a lighting/special effects LUT.
 	*dest = dc_colormap[dc_source[(frac>>FRACBITS)&127]];
 	
-	dest += SCREENWIDTH; 
+	dest += SCREENPITCH_Y; 
 	frac += fracstep;
 	
     } while (count--); 
@@ -146,70 +147,11 @@ void R_DrawColumn (void)
 
 
 
-// UNUSED.
-// Loop unrolled.
-#if 0
-void R_DrawColumn (void) 
-{ 
-    int			count; 
-    byte*		source;
-    byte*		dest;
-    byte*		colormap;
-    
-    unsigned		frac;
-    unsigned		fracstep;
-    unsigned		fracstep2;
-    unsigned		fracstep3;
-    unsigned		fracstep4;	 
- 
-    count = dc_yh - dc_yl + 1; 
-
-    source = dc_source;
-    colormap = dc_colormap;		 
-    dest = ylookup[dc_yl] + columnofs[dc_x];  
-	 
-    fracstep = dc_iscale<<9; 
-    frac = (dc_texturemid + (dc_yl-centery)*dc_iscale)<<9; 
- 
-    fracstep2 = fracstep+fracstep;
-    fracstep3 = fracstep2+fracstep;
-    fracstep4 = fracstep3+fracstep;
-	
-    while (count >= 8) 
-    { 
-	dest[0] = colormap[source[frac>>25]]; 
-	dest[SCREENWIDTH] = colormap[source[(frac+fracstep)>>25]]; 
-	dest[SCREENWIDTH*2] = colormap[source[(frac+fracstep2)>>25]]; 
-	dest[SCREENWIDTH*3] = colormap[source[(frac+fracstep3)>>25]];
-	
-	frac += fracstep4; 
-
-	dest[SCREENWIDTH*4] = colormap[source[frac>>25]]; 
-	dest[SCREENWIDTH*5] = colormap[source[(frac+fracstep)>>25]]; 
-	dest[SCREENWIDTH*6] = colormap[source[(frac+fracstep2)>>25]]; 
-	dest[SCREENWIDTH*7] = colormap[source[(frac+fracstep3)>>25]]; 
-
-	frac += fracstep4; 
-	dest += SCREENWIDTH*8; 
-	count -= 8;
-    } 
-	
-    while (count > 0)
-    { 
-	*dest = colormap[source[frac>>25]]; 
-	dest += SCREENWIDTH; 
-	frac += fracstep; 
-	count--;
-    } 
-}
-#endif
-
-
 void R_DrawColumnLow (void) 
 { 
     int			count; 
-    byte*		dest; 
-    byte*		dest2;
+    pixel_t*		dest; 
+    pixel_t*		dest2;
     fixed_t		frac;
     fixed_t		fracstep;	 
     int                 x;
@@ -243,19 +185,278 @@ void R_DrawColumnLow (void)
     {
 	// Hack. Does not work corretly.
 	*dest2 = *dest = dc_colormap[dc_source[(frac>>FRACBITS)&127]];
-	dest += SCREENWIDTH;
-	dest2 += SCREENWIDTH;
+	dest += SCREENPITCH_Y;
+	dest2 += SCREENPITCH_Y;
 	frac += fracstep; 
 
     } while (count--);
 }
 
 
+//
+// Batched columns.
+// Two queued columns next to each other with the same scale, texture
+//  offset, light and height (sprites, sky, walls facing the view) step
+//  through their textures alike, so the rows they share are drawn in
+//  one pass. In low detail a pair covers four screen columns.
+// Each row computes the same frac as R_DrawColumn, whatever row a pass
+//  starts at, so the result is the same as drawing column by column.
+//
+drawcolumn_t	drawcolumns[MAXDRAWCOLUMNS];
+drawcolumn_t*	drawcolumn_p = drawcolumns;
+
+//
+// R_DrawTallColumnRun
+// Textures of any other height than a power of two wrap at their own
+//  height, which takes a compare per pixel instead of a mask.
+//
+static void R_DrawTallColumnRun (drawcolumn_t* col, int yl, int yh)
+{
+    int			count;
+    pixel_t*		dest;
+    byte*		source;
+    lighttable_t*	colormap;
+    unsigned int	heightfrac;
+    unsigned int	frac;
+    unsigned int	fracstep;
+    int64_t		start;
+    pixel_t		pixel;
+
+    count = yh - yl;
+    dest = ylookup[yl] + columnofs[col->x << detailshift];
+    source = col->source;
+    colormap = col->colormap;
+
+    // the step fits in the height, the start is wrapped into it
+    heightfrac = col->height << FRACBITS;
+    fracstep = (unsigned int) col->iscale % heightfrac;
+    start = (int64_t) col->texturemid
+	  + (int64_t) (yl-centery) * (unsigned int) col->iscale;
+    start %= heightfrac;
+    if (start < 0)
+	start += heightfrac;
+    frac = (unsigned int) start;
+
+    do
+    {
+	pixel = colormap[source[frac>>FRACBITS]];
+	dest[0] = pixel;
+	if (detailshift)
+	    dest[SCREENPITCH_X] = pixel;
+	dest += SCREENPITCH_Y;
+	frac += fracstep;
+	if (frac >= heightfrac)
+	    frac -= heightfrac;
+    } while (count--);
+}
+
+static void R_DrawColumnRun (drawcolumn_t* col, int yl, int yh)
+{
+    int			count;
+    pixel_t*		dest;
+    byte*		source;
+    lighttable_t*	colormap;
+    fixed_t		frac;
+    fixed_t		fracstep;
+    int			mask;
+    pixel_t		pixel;
+
+    count = yh - yl + 1;
+
+    if (count <= 0)
+	return;
+
+#ifdef RANGECHECK 
+    if ((unsigned)col->x >= SCREENWIDTH
+	|| yl < 0
+	|| yh >= SCREENHEIGHT) 
+	I_Error ("R_DrawColumnRun: %i to %i at %i", yl, yh, col->x); 
+#endif 
+
+    if (col->height & (col->height-1))
+    {
+	R_DrawTallColumnRun (col, yl, yh);
+	return;
+    }
+
+    dest = ylookup[yl] + columnofs[col->x << detailshift];
+    source = col->source;
+    colormap = col->colormap;
+    mask = col->height-1;
+    fracstep = col->iscale;
+    frac = col->texturemid + (yl-centery)*fracstep;
+
+    if (detailshift)
+    {
+	do
+	{
+	    pixel = colormap[source[(frac>>FRACBITS)&mask]];
+	    dest[0] = pixel;
+	    dest[SCREENPITCH_X] = pixel;
+	    dest += SCREENPITCH_Y;
+	    frac += fracstep;
+	} while (--count);
+    }
+    else
+    {
+	// unrolled by four, the loop overhead is as large as a pixel
+	while (count >= 4)
+	{
+	    dest[0] = colormap[source[(frac>>FRACBITS)&mask]];
+	    frac += fracstep;
+	    dest[SCREENPITCH_Y] = colormap[source[(frac>>FRACBITS)&mask]];
+	    frac += fracstep;
+	    dest[2*SCREENPITCH_Y] = colormap[source[(frac>>FRACBITS)&mask]];
+	    frac += fracstep;
+	    dest[3*SCREENPITCH_Y] = colormap[source[(frac>>FRACBITS)&mask]];
+	    frac += fracstep;
+	    dest += 4*SCREENPITCH_Y;
+	    count -= 4;
+	}
+
+	while (count--)
+	{
+	    *dest = colormap[source[(frac>>FRACBITS)&mask]];
+	    dest += SCREENPITCH_Y;
+	    frac += fracstep;
+	}
+    }
+}
+
+//
+// R_DrawColumnPairRun
+// Only paired for power of two heights.
+//
+static void R_DrawColumnPairRun (drawcolumn_t* col, int yl, int yh)
+{
+    int			count;
+    pixel_t*		dest;
+    byte*		source;
+    byte*		source2;
+    lighttable_t*	colormap;
+    fixed_t		frac;
+    fixed_t		fracstep;
+    int			mask;
+    int			spot;
+    pixel_t		pixel;
+    pixel_t		pixel2;
+
+    count = yh - yl + 1;
+
+#ifdef RANGECHECK 
+    if ((unsigned)col->x >= SCREENWIDTH-1
+	|| yl < 0
+	|| yh >= SCREENHEIGHT) 
+	I_Error ("R_DrawColumnPairRun: %i to %i at %i", yl, yh, col->x); 
+#endif 
+
+    dest = ylookup[yl] + columnofs[col->x << detailshift];
+    source = col[0].source;
+    source2 = col[1].source;
+    colormap = col->colormap;
+    mask = col->height-1;
+    fracstep = col->iscale;
+    frac = col->texturemid + (yl-centery)*fracstep;
+
+    if (detailshift)
+    {
+	do
+	{
+	    spot = (frac>>FRACBITS)&mask;
+	    pixel = colormap[source[spot]];
+	    pixel2 = colormap[source2[spot]];
+	    dest[0] = pixel;
+	    dest[SCREENPITCH_X] = pixel;
+	    dest[2*SCREENPITCH_X] = pixel2;
+	    dest[3*SCREENPITCH_X] = pixel2;
+	    dest += SCREENPITCH_Y;
+	    frac += fracstep;
+	} while (--count);
+    }
+    else
+    {
+	while (count >= 2)
+	{
+	    spot = (frac>>FRACBITS)&mask;
+	    dest[0] = colormap[source[spot]];
+	    dest[SCREENPITCH_X] = colormap[source2[spot]];
+	    frac += fracstep;
+	    spot = (frac>>FRACBITS)&mask;
+	    dest[SCREENPITCH_Y] = colormap[source[spot]];
+	    dest[SCREENPITCH_Y+SCREENPITCH_X] = colormap[source2[spot]];
+	    frac += fracstep;
+	    dest += 2*SCREENPITCH_Y;
+	    count -= 2;
+	}
+
+	if (count)
+	{
+	    spot = (frac>>FRACBITS)&mask;
+	    dest[0] = colormap[source[spot]];
+	    dest[SCREENPITCH_X] = colormap[source2[spot]];
+	}
+    }
+}
+
+//
+// R_FlushColumns
+// Draws the queued columns and empties the queue.
+//
+void R_FlushColumns (void)
+{
+    drawcolumn_t*	col;
+    drawcolumn_t*	next;
+    int			yl;
+    int			yh;
+
+    for (col = drawcolumns ; col < drawcolumn_p ; col++)
+    {
+	next = col+1;
+
+	if (next < drawcolumn_p
+	    && next->x == col->x+1
+	    && next->iscale == col->iscale
+	    && next->texturemid == col->texturemid
+	    && next->colormap == col->colormap
+	    && next->height == col->height
+	    && !(col->height & (col->height-1)))
+	{
+	    yl = col->yl > next->yl ? col->yl : next->yl;
+	    yh = col->yh < next->yh ? col->yh : next->yh;
+
+	    if (yl <= yh)
+	    {
+		// the shared rows, and what either column has beyond them
+		R_DrawColumnPairRun (col, yl, yh);
+		R_DrawColumnRun (col, col->yl, yl-1);
+		R_DrawColumnRun (col, yh+1, col->yh);
+		R_DrawColumnRun (next, next->yl, yl-1);
+		R_DrawColumnRun (next, yh+1, next->yh);
+		col++;
+		continue;
+	    }
+	}
+
+	R_DrawColumnRun (col, col->yl, col->yh);
+    }
+
+    drawcolumn_p = drawcolumns;
+}
+
+
 //
 // Spectre/Invisibility.
 //
 #define FUZZTABLE		50 
-#define FUZZOFF	(SCREENWIDTH)
+#define FUZZOFF	(SCREENPITCH_Y)
+
+#ifdef FEATURE_RGB565_VIDEO
+// Colormap #6 darkens by about a fifth,
+//  approximated as 3/4 of each RGB565 component.
+#define FUZZPIXEL(p)	((((p) >> 1) & 0x7bef) + (((p) >> 2) & 0x39e7))
+#else
+#define FUZZPIXEL(p)	(colormaps[6*256+(p)])
+#endif
 
 
 int	fuzzoffset[FUZZTABLE] =
@@ -283,7 +484,7 @@ int	fuzzpos = 0;
 void R_DrawFuzzColumn (void) 
 { 
     int			count; 
-    byte*		dest; 
+    pixel_t*		dest; 
     fixed_t		frac;
     fixed_t		fracstep;	 
 
@@ -325,13 +526,13 @@ void R_DrawFuzzColumn (void)
 	//  a pixel that is either one column
 	//  left or right of the current one.
 	// Add index from colormap to index.
-	*dest = colormaps[6*256+dest[fuzzoffset[fuzzpos]]]; 
+	*dest = FUZZPIXEL(dest[fuzzoffset[fuzzpos]]); 
 
 	// Clamp table lookup index.
 	if (++fuzzpos == FUZZTABLE) 
 	    fuzzpos = 0;
 	
-	dest += SCREENWIDTH;
+	dest += SCREENPITCH_Y;
 
 	frac += fracstep; 
     } while (count--); 
@@ -342,8 +543,8 @@ void R_DrawFuzzColumn (void)
 void R_DrawFuzzColumnLow (void) 
 { 
     int			count; 
-    byte*		dest; 
-    byte*		dest2; 
+    pixel_t*		dest; 
+    pixel_t*		dest2; 
     fixed_t		frac;
     fixed_t		fracstep;	 
     int x;
@@ -391,15 +592,15 @@ void R_DrawFuzzColumnLow (void)
 	//  a pixel that is either one column
 	//  left or right of the current one.
 	// Add index from colormap to index.
-	*dest = colormaps[6*256+dest[fuzzoffset[fuzzpos]]]; 
-	*dest2 = colormaps[6*256+dest2[fuzzoffset[fuzzpos]]]; 
+	*dest = FUZZPIXEL(dest[fuzzoffset[fuzzpos]]); 
+	*dest2 = FUZZPIXEL(dest2[fuzzoffset[fuzzpos]]); 
 
 	// Clamp table lookup index.
 	if (++fuzzpos == FUZZTABLE) 
 	    fuzzpos = 0;
 	
-	dest += SCREENWIDTH;
-	dest2 += SCREENWIDTH;
+	dest += SCREENPITCH_Y;
+	dest2 += SCREENPITCH_Y;
 
 	frac += fracstep; 
     } while (count--); 
@@ -424,7 +625,7 @@ byte*	translationtables;
 void R_DrawTranslatedColumn (void) 
 { 
     int			count; 
-    byte*		dest; 
+    pixel_t*		dest; 
     fixed_t		frac;
     fixed_t		fracstep;	 
  
@@ -459,7 +660,7 @@ void R_DrawTranslatedColumn (void)
 	// Thus the "green" ramp of the player 0 sprite
 	//  is mapped to gray, red, black/indigo. 
 	*dest = dc_colormap[dc_translation[dc_source[frac>>FRACBITS]]];
-	dest += SCREENWIDTH;
+	dest += SCREENPITCH_Y;
 	
 	frac += fracstep; 
     } while (count--); 
@@ -468,8 +669,8 @@ void R_DrawTranslatedColumn (void)
 void R_DrawTranslatedColumnLow (void) 
 { 
     int			count; 
-    byte*		dest; 
-    byte*		dest2; 
+    pixel_t*		dest; 
+    pixel_t*		dest2; 
     fixed_t		frac;
     fixed_t		fracstep;	 
     int                 x;
@@ -510,8 +711,8 @@ void R_DrawTranslatedColumnLow (void)
 	//  is mapped to gray, red, black/indigo. 
 	*dest = dc_colormap[dc_translation[dc_source[frac>>FRACBITS]]];
 	*dest2 = dc_colormap[dc_translation[dc_source[frac>>FRACBITS]]];
-	dest += SCREENWIDTH;
-	dest2 += SCREENWIDTH;
+	dest += SCREENPITCH_Y;
+	dest2 += SCREENPITCH_Y;
 	
 	frac += fracstep; 
     } while (count--); 
@@ -585,15 +786,49 @@ byte*			ds_source;
 int			dscount;
 
 
+//
+// The flat position and step are packed into a single 32-bit integer,
+//  with x in the top 16 bits and y in the bottom 16 bits. For each
+//  16-bit part, the top 6 bits are the integer part and the bottom
+//  10 bits are the fractional part of the pixel position.
+//
+#define SPANPOSITION(xfrac, yfrac) \
+    ((((xfrac) << 10) & 0xffff0000) | (((yfrac) >> 6) & 0x0000ffff))
+
+// Texture index of a packed position in the 64*64 flat.
+#define SPANSPOT(position) \
+    ((((position) >> 4) & 0x0fc0) | ((position) >> 26))
+
+#ifndef FEATURE_COLUMN_MAJOR_VIDEO
+// Four neighbouring pixels in a word of the row-major screen.
+#ifdef SYS_BIG_ENDIAN
+#define SPANWORD(a, b, c, d) \
+    (((uint32_t) (a) << 24) | ((uint32_t) (b) << 16) \
+   | ((uint32_t) (c) << 8) | (uint32_t) (d))
+#else
+#define SPANWORD(a, b, c, d) \
+    ((uint32_t) (a) | ((uint32_t) (b) << 8) \
+   | ((uint32_t) (c) << 16) | ((uint32_t) (d) << 24))
+#endif
+#endif
+
 //
 // Draws the actual span.
+// Four pixels per iteration. On the row-major screen they are
+//  stored as one aligned word, on the column-major screen they
+//  are a column apart.
+//
 void R_DrawSpan (void) 
 { 
-    unsigned int position, step;
-    byte *dest;
-    int count;
-    int spot;
-    unsigned int xtemp, ytemp;
+    unsigned int	position;
+    unsigned int	step;
+    byte*		source;
+    lighttable_t*	colormap;
+    pixel_t*		dest;
+    int			count;
+#ifndef FEATURE_COLUMN_MAJOR_VIDEO
+    lighttable_t	p0, p1, p2, p3;
+#endif
 
 #ifdef RANGECHECK
     if (ds_x2 < ds_x1
@@ -607,122 +842,75 @@ void R_DrawSpan (void)
 //	dscount++;
 #endif
 
-    // Pack position and step variables into a single 32-bit integer,
-    // with x in the top 16 bits and y in the bottom 16 bits.  For
-    // each 16-bit part, the top 6 bits are the integer part and the
-    // bottom 10 bits are the fractional part of the pixel position.
-
-    position = ((ds_xfrac << 10) & 0xffff0000)
-             | ((ds_yfrac >> 6)  & 0x0000ffff);
-    step = ((ds_xstep << 10) & 0xffff0000)
-         | ((ds_ystep >> 6)  & 0x0000ffff);
+    position = SPANPOSITION(ds_xfrac, ds_yfrac);
+    step = SPANPOSITION(ds_xstep, ds_ystep);
+    source = ds_source;
+    colormap = ds_colormap;
 
     dest = ylookup[ds_y] + columnofs[ds_x1];
+    count = ds_x2 - ds_x1 + 1;
 
-    // We do not check for zero spans here?
-    count = ds_x2 - ds_x1;
-
-    do
+#ifdef FEATURE_COLUMN_MAJOR_VIDEO
+    while (count >= 4)
     {
-	// Calculate current texture index in u,v.
-        ytemp = (position >> 4) & 0x0fc0;
-        xtemp = (position >> 26);
-        spot = xtemp | ytemp;
-
-	// Lookup pixel from flat texture tile,
-	//  re-index using light/colormap.
-	*dest++ = ds_colormap[ds_source[spot]];
-
-        position += step;
-
-    } while (count--);
-}
-
-
-
-// UNUSED.
-// Loop unrolled by 4.
-#if 0
-void R_DrawSpan (void) 
-{ 
-    unsigned	position, step;
-
-    byte*	source;
-    byte*	colormap;
-    byte*	dest;
-    
-    unsigned	count;
-    usingned	spot; 
-    unsigned	value;
-    unsigned	temp;
-    unsigned	xtemp;
-    unsigned	ytemp;
-		
-    position = ((ds_xfrac<<10)&0xffff0000) | ((ds_yfrac>>6)&0xffff);
-    step = ((ds_xstep<<10)&0xffff0000) | ((ds_ystep>>6)&0xffff);
-		
-    source = ds_source;
-    colormap = ds_colormap;
-    dest = ylookup[ds_y] + columnofs[ds_x1];	 
-    count = ds_x2 - ds_x1 + 1; 
-	
-    while (count >= 4) 
-    { 
-	ytemp = position>>4;
-	ytemp = ytemp & 4032;
-	xtemp = position>>26;
-	spot = xtemp | ytemp;
+	dest[0] = colormap[source[SPANSPOT(position)]];
 	position += step;
-	dest[0] = colormap[source[spot]]; 
-
-	ytemp = position>>4;
-	ytemp = ytemp & 4032;
-	xtemp = position>>26;
-	spot = xtemp | ytemp;
+	dest[SCREENPITCH_X] = colormap[source[SPANSPOT(position)]];
 	position += step;
-	dest[1] = colormap[source[spot]];
-	
-	ytemp = position>>4;
-	ytemp = ytemp & 4032;
-	xtemp = position>>26;
-	spot = xtemp | ytemp;
+	dest[2*SCREENPITCH_X] = colormap[source[SPANSPOT(position)]];
 	position += step;
-	dest[2] = colormap[source[spot]];
-	
-	ytemp = position>>4;
-	ytemp = ytemp & 4032;
-	xtemp = position>>26;
-	spot = xtemp | ytemp;
+	dest[3*SCREENPITCH_X] = colormap[source[SPANSPOT(position)]];
 	position += step;
-	dest[3] = colormap[source[spot]]; 
-		
+	dest += 4*SCREENPITCH_X;
 	count -= 4;
-	dest += 4;
-    } 
-    while (count > 0) 
-    { 
-	ytemp = position>>4;
-	ytemp = ytemp & 4032;
-	xtemp = position>>26;
-	spot = xtemp | ytemp;
+    }
+#else
+    // up to a word boundary
+    while (count > 0 && ((uintptr_t) dest & 3))
+    {
+	*dest++ = colormap[source[SPANSPOT(position)]];
 	position += step;
-	*dest++ = colormap[source[spot]]; 
 	count--;
-    } 
-} 
+    }
+
+    while (count >= 4)
+    {
+	p0 = colormap[source[SPANSPOT(position)]];
+	position += step;
+	p1 = colormap[source[SPANSPOT(position)]];
+	position += step;
+	p2 = colormap[source[SPANSPOT(position)]];
+	position += step;
+	p3 = colormap[source[SPANSPOT(position)]];
+	position += step;
+	*(uint32_t *) dest = SPANWORD(p0, p1, p2, p3);
+	dest += 4;
+	count -= 4;
+    }
 #endif
 
+    while (count-- > 0)
+    {
+	*dest = colormap[source[SPANSPOT(position)]];
+	dest += SCREENPITCH_X;
+	position += step;
+    }
+}
+
 
 //
 // Again..
+// Each texel covers two pixels, so two texels per iteration.
 //
 void R_DrawSpanLow (void)
 {
-    unsigned int position, step;
-    unsigned int xtemp, ytemp;
-    byte *dest;
-    int count;
-    int spot;
+    unsigned int	position;
+    unsigned int	step;
+    byte*		source;
+    lighttable_t*	colormap;
+    pixel_t*		dest;
+    int			count;
+    lighttable_t	p0, p1;
 
 #ifdef RANGECHECK
     if (ds_x2 < ds_x1
@@ -736,34 +924,60 @@ void R_DrawSpanLow (void)
 //	dscount++; 
 #endif
 
-    position = ((ds_xfrac << 10) & 0xffff0000)
-             | ((ds_yfrac >> 6)  & 0x0000ffff);
-    step = ((ds_xstep << 10) & 0xffff0000)
-         | ((ds_ystep >> 6)  & 0x0000ffff);
-
-    count = (ds_x2 - ds_x1);
+    position = SPANPOSITION(ds_xfrac, ds_yfrac);
+    step = SPANPOSITION(ds_xstep, ds_ystep);
+    source = ds_source;
+    colormap = ds_colormap;
 
     // Blocky mode, need to multiply by 2.
-    ds_x1 <<= 1;
-    ds_x2 <<= 1;
-
-    dest = ylookup[ds_y] + columnofs[ds_x1];
+    dest = ylookup[ds_y] + columnofs[ds_x1 << 1];
+    count = ds_x2 - ds_x1 + 1;
 
-    do
+#ifdef FEATURE_COLUMN_MAJOR_VIDEO
+    while (count >= 2)
     {
-	// Calculate current texture index in u,v.
-        ytemp = (position >> 4) & 0x0fc0;
-        xtemp = (position >> 26);
-        spot = xtemp | ytemp;
-
-	// Lowres/blocky mode does it twice,
-	//  while scale is adjusted appropriately.
-	*dest++ = ds_colormap[ds_source[spot]];
-	*dest++ = ds_colormap[ds_source[spot]];
+	p0 = colormap[source[SPANSPOT(position)]];
+	position += step;
+	p1 = colormap[source[SPANSPOT(position)]];
+	position += step;
+	dest[0] = p0;
+	dest[SCREENPITCH_X] = p0;
+	dest[2*SCREENPITCH_X] = p1;
+	dest[3*SCREENPITCH_X] = p1;
+	dest += 4*SCREENPITCH_X;
+	count -= 2;
+    }
+#else
+    // pixel pairs are halfword aligned, one may be needed to
+    //  reach a word boundary
+    if (count > 0 && ((uintptr_t) dest & 3))
+    {
+	p0 = colormap[source[SPANSPOT(position)]];
+	position += step;
+	dest[0] = p0;
+	dest[1] = p0;
+	dest += 2;
+	count--;
+    }
 
+    while (count >= 2)
+    {
+	p0 = colormap[source[SPANSPOT(position)]];
 	position += step;
+	p1 = colormap[source[SPANSPOT(position)]];
+	position += step;
+	*(uint32_t *) dest = SPANWORD(p0, p0, p1, p1);
+	dest += 4;
+	count -= 2;
+    }
+#endif
 
-    } while (count--);
+    if (count > 0)
+    {
+	p0 = colormap[source[SPANSPOT(position)]];
+	dest[0] = p0;
+	dest[SCREENPITCH_X] = p0;
+    }
 }
 
 //
@@ -787,7 +1001,7 @@ R_InitBuffer
 
     // Column offset. For windows.
     for (i=0 ; i<width ; i++) 
-	columnofs[i] = viewwindowx + i;
+	columnofs[i] = (viewwindowx + i) * SCREENPITCH_X;
 
     // Samw with base row offset.
     if (width == SCREENWIDTH) 
@@ -797,7 +1011,7 @@ R_InitBuffer
 
     // Preclaculate all row offsets.
     for (i=0 ; i<height ; i++) 
-	ylookup[i] = I_VideoBuffer + (i+viewwindowy)*SCREENWIDTH; 
+	ylookup[i] = I_VideoBuffer + SCREENOFFSET(0, i+viewwindowy); 
 } 
  
  
@@ -812,7 +1026,7 @@ R_InitBuffer
 void R_FillBackScreen (void) 
 { 
     byte*	src;
-    byte*	dest; 
+    pixel_t*	dest; 
     int		x;
     int		y; 
     patch_t*	patch;
@@ -843,8 +1057,14 @@ void R_FillBackScreen (void)
 	
     if (background_buffer == NULL)
     {
+#ifdef FEATURE_COLUMN_MAJOR_VIDEO
+        // Full columns, the status bar rows come first in each of them.
+        background_buffer = Z_Malloc(SCREENWIDTH * SCREENHEIGHT * sizeof(pixel_t),
+                                     PU_STATIC, NULL);
+#else
         background_buffer = Z_Malloc(SCREENWIDTH * (SCREENHEIGHT - SBARHEIGHT),
                                      PU_STATIC, NULL);
+#endif
     }
 
     if (gamemode == commercial)
@@ -853,6 +1073,19 @@ void R_FillBackScreen (void)
 	name = name1;
     
     src = W_CacheLumpName(name, PU_CACHE); 
+
+#ifdef FEATURE_COLUMN_MAJOR_VIDEO
+    for (x=0 ; x<SCREENWIDTH ; x++) 
+    { 
+	dest = background_buffer + SCREENOFFSET(x, 0);
+
+	for (y=0 ; y<SCREENHEIGHT-SBARHEIGHT ; y++) 
+	{ 
+	    *dest = I_PIXEL(src[((y&63)<<6) + (x&63)]); 
+	    dest += SCREENPITCH_Y; 
+	} 
+    } 
+#else
     dest = background_buffer;
 	 
     for (y=0 ; y<SCREENHEIGHT-SBARHEIGHT ; y++) 
@@ -869,6 +1102,7 @@ void R_FillBackScreen (void)
 	    dest += (SCREENWIDTH&63); 
 	} 
     } 
+#endif
      
     // Draw screen and bezel; this is done to a separate screen buffer.
 
@@ -917,19 +1151,47 @@ void R_FillBackScreen (void)
 //
 void
 R_VideoErase
-( unsigned	ofs,
-  int		count ) 
+( int		x,
+  int		y,
+  int		width,
+  int		height ) 
 { 
+    pixel_t*	src;
+    pixel_t*	dest;
+
   // LFB copy.
   // This might not be a good idea if memcpy
   //  is not optiomal, e.g. byte by byte on
   //  a 32bit CPU, as GNU GCC/Linux libc did
   //  at one point.
 
-    if (background_buffer != NULL)
-    {
-        memcpy(I_VideoBuffer + ofs, background_buffer + ofs, count); 
-    }
+    if (background_buffer == NULL || width <= 0 || height <= 0)
+	return;
+
+    V_MarkRect (x, y, width, height);
+
+#ifdef FEATURE_COLUMN_MAJOR_VIDEO
+    // Columns are contiguous, from the bottom up.
+    src = background_buffer + SCREENOFFSET(x, y+height-1);
+    dest = I_VideoBuffer + SCREENOFFSET(x, y+height-1);
+
+    for ( ; width>0 ; width--) 
+    { 
+	memcpy(dest, src, height*sizeof(pixel_t)); 
+	src += SCREENPITCH_X; 
+	dest += SCREENPITCH_X; 
+    } 
+#else
+    src = background_buffer + SCREENOFFSET(x, y);
+    dest = I_VideoBuffer + SCREENOFFSET(x, y);
+
+    for ( ; height>0 ; height--) 
+    { 
+	memcpy(dest, src, width); 
+	src += SCREENPITCH_Y; 
+	dest += SCREENPITCH_Y; 
+    } 
+#endif
 } 
 
 
@@ -942,8 +1204,6 @@ void R_DrawViewBorder (void)
 { 
     int		top;
     int		side;
-    int		ofs;
-    int		i; 
  
     if (scaledviewwidth == SCREENWIDTH) 
 	return; 
@@ -951,22 +1211,13 @@ void R_DrawViewBorder (void)
     top = ((SCREENHEIGHT-SBARHEIGHT)-viewheight)/2; 
     side = (SCREENWIDTH-scaledviewwidth)/2; 
  
-    // copy top and one line of left side 
-    R_VideoErase (0, top*SCREENWIDTH+side); 
- 
-    // copy one line of right side and bottom 
-    ofs = (viewheight+top)*SCREENWIDTH-side; 
-    R_VideoErase (ofs, top*SCREENWIDTH+side); 
+    // copy top and bottom
+    R_VideoErase (0, 0, SCREENWIDTH, top); 
+    R_VideoErase (0, viewheight+top, SCREENWIDTH, top); 
  
-    // copy sides using wraparound 
-    ofs = top*SCREENWIDTH + SCREENWIDTH-side; 
-    side <<= 1;
-    
-    for (i=1 ; i<viewheight ; i++) 
-    { 
-	R_VideoErase (ofs, side); 
-	ofs += SCREENWIDTH; 
-    } 
+    // copy sides
+    R_VideoErase (0, top, side, viewheight); 
+    R_VideoErase (SCREENWIDTH-side, top, side, viewheight); 
 
     // ? 
     V_MarkRect (0,0,SCREENWIDTH, SCREENHEIGHT-SBARHEIGHT); 
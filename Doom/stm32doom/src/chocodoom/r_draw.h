@@ -50,10 +50,71 @@ void 	R_DrawFuzzColumnLow (void);
 void	R_DrawTranslatedColumn (void);
 void	R_DrawTranslatedColumnLow (void);
 
+//
+// Batched column drawing.
+// Walls, sky and plain sprite columns are queued as descriptors
+//  and drawn by R_FlushColumns, with the detail of basecolfunc.
+// The queue has to be flushed before the sources of its columns
+//  may be purged, and before anything else draws over them.
+// The height picks the drawer: power of two heights are masked,
+//  others wrap at their height (see FEATURE_TALL_TEXTURES).
+//
+typedef struct
+{
+    byte*		source;
+    lighttable_t*	colormap;
+    fixed_t		iscale;
+    fixed_t		texturemid;
+    short		x;
+    short		yl;
+    short		yh;
+    short		height;
+} drawcolumn_t;
+
+#define MAXDRAWCOLUMNS		128
+
+// Texture rows wrap at this height, as in vanilla.
+#define COLUMNHEIGHT		128
+
+extern drawcolumn_t	drawcolumns[MAXDRAWCOLUMNS];
+extern drawcolumn_t*	drawcolumn_p;
+
+void	R_FlushColumns (void);
+
+static inline void
+R_QueueColumn
+( byte*		source,
+  lighttable_t*	colormap,
+  int		x,
+  int		yl,
+  int		yh,
+  fixed_t	iscale,
+  fixed_t	texturemid,
+  int		height )
+{
+    drawcolumn_t*	col;
+
+    if (drawcolumn_p == &drawcolumns[MAXDRAWCOLUMNS])
+	R_FlushColumns ();
+
+    col = drawcolumn_p++;
+    col->source = source;
+    col->colormap = colormap;
+    col->iscale = iscale;
+    col->texturemid = texturemid;
+    col->x = x;
+    col->yl = yl;
+    col->yh = yh;
+    col->height = height;
+}
+
+// Copies a rectangle of the view border from the back screen.
 void
 R_VideoErase
-( unsigned	ofs,
-  int		count );
+( int		x,
+  int		y,
+  int		width,
+  int		height );
 
 extern int		ds_y;
 extern int		ds_x1;
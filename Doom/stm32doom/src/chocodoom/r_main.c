@@ -23,10 +23,13 @@
 
 
 #include <stdlib.h>
+#include <string.h>
 #include <math.h>
 
 
+#include "z_zone.h"
 #include "doomdef.h"
+#include "doomstat.h"
 #include "d_loop.h"
 
 #include "m_bbox.h"
@@ -34,6 +37,7 @@
 
 #include "r_local.h"
 #include "r_sky.h"
+#include "v_video.h"
 
 
 
@@ -78,6 +82,44 @@ fixed_t			viewsin;
 
 player_t*		viewplayer;
 
+// Sectors visited by the last render, in BSP order.
+sector_t**		viewsectors;
+int			numviewsectors;
+
+rendercounts_t		renderframe;
+rendercounts_t		renderpeak;
+
+// The view point and window of a render, plain values compared
+//  before the world is hashed, so that a moving view pays nothing.
+typedef struct
+{
+    player_t*		player;
+    fixed_t		x;
+    fixed_t		y;
+    fixed_t		z;
+    angle_t		angle;
+    int			extralight;
+    int			fixedcolormap;
+    int			windowx;
+    int			windowy;
+    int			width;
+    int			height;
+    int			detail;
+#ifdef FEATURE_RGB565_VIDEO
+    // the view holds pixels of the palette it was drawn with
+    const uint16_t*	palette;
+#endif
+    pspdef_t		psprites[NUMPSPRITES];
+} viewpoint_t;
+
+// The 3D view of the last render, kept while nothing seen changes.
+static pixel_t*		viewcache;
+static int		viewcachesize;
+static boolean		viewcachevalid;
+static viewpoint_t	viewpoint;
+static boolean		viewsignaturevalid;
+static unsigned int	viewsignature;
+
 // 0 = high, 1 = low
 int			detailshift;	
 
@@ -258,6 +300,29 @@ R_PointOnSegSide
 }
 
 
+// The octants, indexed by x<0, y<0 and x>y (after the flips).
+// The angle is base plus or minus the tantoangle[] of the octant,
+//  which takes a single branch-free lookup instead of a branch
+//  per octant, with the same results.
+typedef struct
+{
+    angle_t	base;
+    angle_t	negate;		// all bits set to subtract
+} octant_t;
+
+static const octant_t octants[8] =
+{
+    { ANG90-1,	~0u },		// octant 1
+    { 0,	0 },		// octant 0
+    { ANG270,	0 },		// octant 7
+    { 0,	~0u },		// octant 8
+    { ANG90,	0 },		// octant 2
+    { ANG180-1,	~0u },		// octant 3
+    { ANG270-1,	~0u },		// octant 5
+    { ANG180,	0 }		// octant 4
+};
+
+
 //
 // R_PointToAngle
 // To get a global angle from cartesian coordinates,
@@ -277,84 +342,43 @@ R_PointToAngle
 ( fixed_t	x,
   fixed_t	y )
 {	
+    const octant_t*	octant;
+    int			index;
+    angle_t		angle;
+
     x -= viewx;
     y -= viewy;
     
     if ( (!x) && (!y) )
 	return 0;
 
-    if (x>= 0)
+    index = 0;
+
+    if (x < 0)
     {
-	// x >=0
-	if (y>= 0)
-	{
-	    // y>= 0
+	x = -x;
+	index = 4;
+    }
 
-	    if (x>y)
-	    {
-		// octant 0
-		return tantoangle[ SlopeDiv(y,x)];
-	    }
-	    else
-	    {
-		// octant 1
-		return ANG90-1-tantoangle[ SlopeDiv(x,y)];
-	    }
-	}
-	else
-	{
-	    // y<0
-	    y = -y;
+    if (y < 0)
+    {
+	y = -y;
+	index += 2;
+    }
 
-	    if (x>y)
-	    {
-		// octant 8
-		return -tantoangle[SlopeDiv(y,x)];
-	    }
-	    else
-	    {
-		// octant 7
-		return ANG270+tantoangle[ SlopeDiv(x,y)];
-	    }
-	}
+    if (x>y)
+    {
+	angle = tantoangle[ SlopeDiv(y,x)];
+	index++;
     }
     else
     {
-	// x<0
-	x = -x;
+	angle = tantoangle[ SlopeDiv(x,y)];
+    }
 
-	if (y>= 0)
-	{
-	    // y>= 0
-	    if (x>y)
-	    {
-		// octant 3
-		return ANG180-1-tantoangle[ SlopeDiv(y,x)];
-	    }
-	    else
-	    {
-		// octant 2
-		return ANG90+ tantoangle[ SlopeDiv(x,y)];
-	    }
-	}
-	else
-	{
-	    // y<0
-	    y = -y;
+    octant = &octants[index];
 
-	    if (x>y)
-	    {
-		// octant 4
-		return ANG180+tantoangle[ SlopeDiv(y,x)];
-	    }
-	    else
-	    {
-		 // octant 5
-		return ANG270-1-tantoangle[ SlopeDiv(x,y)];
-	    }
-	}
-    }
-    return 0;
+    return octant->base + ((angle ^ octant->negate) - octant->negate);
 }
 
 
@@ -396,16 +420,27 @@ R_PointToDist
 
     // Fix crashes in udm1.wad
 
-    if (dx != 0)
+    if (dx > 0 && (unsigned) dy < (1 << (32-SLOPEBITS)))
     {
-        frac = FixedDiv(dy, dx);
+	// dy <= dx, so FixedDiv does not clamp, and
+	//  FixedDiv(dy, dx) >> DBITS is a single division
+	angle = ((unsigned) dy << SLOPEBITS) / (unsigned) dx;
     }
     else
     {
-	frac = 0;
+	if (dx != 0)
+	{
+	    frac = FixedDiv(dy, dx);
+	}
+	else
+	{
+	    frac = 0;
+	}
+
+	angle = frac>>DBITS;
     }
 	
-    angle = (tantoangle[frac>>DBITS]+ANG90) >> ANGLETOFINESHIFT;
+    angle = (tantoangle[angle]+ANG90) >> ANGLETOFINESHIFT;
 
     // use as cosine
     dist = FixedDiv (dx, finesine[angle] );	
@@ -841,7 +876,7 @@ void R_SetupFrame (player_t* player)
     {
 	fixedcolormap =
 	    colormaps
-	    + player->fixedcolormap*256*sizeof(lighttable_t);
+	    + player->fixedcolormap*256;
 	
 	walllights = scalelightfixed;
 
@@ -857,11 +892,318 @@ void R_SetupFrame (player_t* player)
 
 
 
+//
+// R_GrowLimit
+// Moves a zone array of one of the renderer limits to one a chunk
+//  larger, up to its cap. Returns the new array, with count updated,
+//  or NULL at the cap, leaving the array as it was.
+//
+void*
+R_GrowLimit
+( void*		array,
+  int*		count,
+  int		size,
+  int		chunk,
+  int		cap )
+{
+    void*	grown;
+    int		newcount;
+
+    if (*count >= cap)
+	return NULL;
+
+    newcount = *count + chunk;
+    if (newcount > cap)
+	newcount = cap;
+
+    grown = Z_Malloc (newcount*size, PU_STATIC, NULL);
+
+    if (array != NULL)
+    {
+	memcpy (grown, array, *count*size);
+	Z_Free (array);
+    }
+
+    *count = newcount;
+    return grown;
+}
+
+
+//
+// R_CountLimits
+// At the end of each render.
+//
+static void R_CountLimits (void)
+{
+    int		allocated;
+
+    renderframe.visplanes = lastvisplane - visplanes;
+    renderframe.drawsegs = ds_p - drawsegs;
+    renderframe.vissprites = vissprite_p - vissprites;
+    R_CountOpenings (&renderframe.openings, &allocated);
+
+    if (renderpeak.visplanes < renderframe.visplanes)
+	renderpeak.visplanes = renderframe.visplanes;
+    if (renderpeak.drawsegs < renderframe.drawsegs)
+	renderpeak.drawsegs = renderframe.drawsegs;
+    if (renderpeak.vissprites < renderframe.vissprites)
+	renderpeak.vissprites = renderframe.vissprites;
+    if (renderpeak.openings < renderframe.openings)
+	renderpeak.openings = renderframe.openings;
+}
+
+
+//
+// R_DumpLimits
+//
+void R_DumpLimits (void)
+{
+    int		used;
+    int		allocated;
+
+    R_CountOpenings (&used, &allocated);
+
+    printf ("render peak/allocated:  visplanes %i/%i  drawsegs %i/%i"
+	    "  vissprites %i/%i  openings %i/%i\n",
+	    renderpeak.visplanes, numvisplanes,
+	    renderpeak.drawsegs, numdrawsegs,
+	    renderpeak.vissprites, numvissprites,
+	    renderpeak.openings, allocated);
+
+    printf ("composites kept/budget: %i/%i", compositememory, composite_budget);
+#ifdef FEATURE_ZONE_STATS
+    printf ("  hits %i  misses %i  rebuilds %i",
+	    composite_hits, composite_misses, composite_rebuilds);
+    composite_hits = composite_misses = composite_rebuilds = 0;
+#endif
+    printf ("\n");
+
+    memset (&renderpeak, 0, sizeof(renderpeak));
+}
+
+
+//
+// View reuse.
+// A view is reused when its view point (R_GetViewPoint) is the same
+//  as the last render's, and so is the signature of everything in the
+//  sectors that render visited: heights, lights, flats, the walls of
+//  their lines with the sectors behind them, and their things. Then a
+//  render would give the same pixels, so the view is copied from a
+//  cache instead. The world is only hashed while the view point stays.
+//
+#define R_Hash(hash, value) \
+    (((hash) ^ (unsigned int) (value)) * 16777619u)
+
+static unsigned int R_HashSector (unsigned int hash, sector_t* sec)
+{
+    hash = R_Hash (hash, sec->floorheight);
+    hash = R_Hash (hash, sec->ceilingheight);
+    hash = R_Hash (hash, sec->lightlevel);
+    hash = R_Hash (hash, flattranslation[sec->floorpic]);
+    hash = R_Hash (hash, flattranslation[sec->ceilingpic]);
+    return hash;
+}
+
+static unsigned int R_HashSide (unsigned int hash, int sidenum)
+{
+    side_t*	side;
+
+    if (sidenum < 0)
+	return hash;
+
+    side = &sides[sidenum];
+    hash = R_Hash (hash, side->textureoffset);
+    hash = R_Hash (hash, side->rowoffset);
+    hash = R_Hash (hash, texturetranslation[side->toptexture]);
+    hash = R_Hash (hash, texturetranslation[side->bottomtexture]);
+    hash = R_Hash (hash, texturetranslation[side->midtexture]);
+    return hash;
+}
+
+//
+// R_GetViewPoint
+//
+static void R_GetViewPoint (player_t* player, viewpoint_t* point)
+{
+    // zeroed padding, for memcmp
+    memset (point, 0, sizeof(*point));
+
+    point->player = player;
+    point->x = player->mo->x;
+    point->y = player->mo->y;
+    point->z = player->viewz;
+    point->angle = player->mo->angle;
+    point->extralight = player->extralight;
+    point->fixedcolormap = player->fixedcolormap;
+    point->windowx = viewwindowx;
+    point->windowy = viewwindowy;
+    point->width = scaledviewwidth;
+    point->height = viewheight;
+    point->detail = detailshift;
+#ifdef FEATURE_RGB565_VIDEO
+    point->palette = rgb565_palette;
+#endif
+    memcpy (point->psprites, player->psprites, sizeof(point->psprites));
+}
+
+//
+// R_ViewSignature
+// Returns false if the view can not be reused whatever the signature,
+//  as fuzz (spectres, invisibility) changes every frame.
+//
+static boolean R_ViewSignature (player_t* player, unsigned int* signature)
+{
+    unsigned int	hash = 2166136261u;
+    sector_t*		sec;
+    line_t*		line;
+    mobj_t*		thing;
+    int			i;
+    int			j;
+
+    if (player->mo->flags & MF_SHADOW)
+	return false;
+
+    for (i=0 ; i<numviewsectors ; i++)
+    {
+	sec = viewsectors[i];
+	hash = R_HashSector (hash, sec);
+
+	// A sector behind a line (a door, a lift) can become visible
+	//  without having been visited.
+	for (j=0 ; j<sec->linecount ; j++)
+	{
+	    line = sec->lines[j];
+	    hash = R_HashSide (hash, line->sidenum[0]);
+	    hash = R_HashSide (hash, line->sidenum[1]);
+	    if (line->backsector)
+	    {
+		hash = R_HashSector (hash, line->frontsector);
+		hash = R_HashSector (hash, line->backsector);
+	    }
+	}
+
+	for (thing = sec->thinglist ; thing ; thing = thing->snext)
+	{
+	    if (thing->flags & MF_SHADOW)
+		return false;
+
+	    hash = R_Hash (hash, thing->x);
+	    hash = R_Hash (hash, thing->y);
+	    hash = R_Hash (hash, thing->z);
+	    hash = R_Hash (hash, thing->angle);
+	    hash = R_Hash (hash, thing->sprite);
+	    hash = R_Hash (hash, thing->frame);
+	    hash = R_Hash (hash, thing->flags & MF_TRANSLATION);
+	}
+    }
+
+    *signature = hash;
+    return true;
+}
+
+//
+// R_CopyViewCache
+// Saves the view to the cache, or restores it from there.
+//
+static void R_CopyViewCache (boolean restore)
+{
+    pixel_t*	screen;
+    pixel_t*	cache;
+    int		count;
+    int		size;
+
+    cache = viewcache;
+
+#ifdef FEATURE_COLUMN_MAJOR_VIDEO
+    // Columns are contiguous, from the bottom up.
+    screen = I_VideoBuffer + SCREENOFFSET(viewwindowx, viewwindowy+viewheight-1);
+    size = viewheight*sizeof(pixel_t);
+
+    for (count = scaledviewwidth ; count>0 ; count--)
+    {
+	if (restore)
+	    memcpy(screen, cache, size);
+	else
+	    memcpy(cache, screen, size);
+	screen += SCREENPITCH_X;
+	cache += viewheight;
+    }
+#else
+    screen = I_VideoBuffer + SCREENOFFSET(viewwindowx, viewwindowy);
+    size = scaledviewwidth*sizeof(pixel_t);
+
+    for (count = viewheight ; count>0 ; count--)
+    {
+	if (restore)
+	    memcpy(screen, cache, size);
+	else
+	    memcpy(cache, screen, size);
+	screen += SCREENPITCH_Y;
+	cache += scaledviewwidth;
+    }
+#endif
+}
+
+//
+// R_SaveViewCache
+// The cache is purgable, the zone clears viewcache when it takes it back.
+//
+static void R_SaveViewCache (void)
+{
+    int		size;
+
+    size = scaledviewwidth*viewheight*sizeof(pixel_t);
+
+    if (viewcache != NULL && viewcachesize != size)
+	Z_Free (viewcache);
+
+    if (viewcache == NULL)
+    {
+	Z_Malloc (size, PU_CACHE, &viewcache);
+	viewcachesize = size;
+    }
+
+    R_CopyViewCache (false);
+    viewcachevalid = true;
+}
+
+
 //
 // R_RenderView
 //
 void R_RenderPlayerView (player_t* player)
 {	
+    viewpoint_t		point;
+    boolean		samepoint;
+    unsigned int	signature;
+    boolean		unchanged;
+
+    // The sector list is freed with the level.
+    if (viewsectors == NULL)
+    {
+	Z_Malloc (numsectors*sizeof(*viewsectors), PU_LEVEL, &viewsectors);
+	numviewsectors = 0;
+	viewsignaturevalid = false;
+    }
+
+    R_GetViewPoint (player, &point);
+    samepoint = !memcmp (&point, &viewpoint, sizeof(point));
+
+    // Demos render every frame, for timing and comparisons.
+    unchanged = !demoplayback
+	     && samepoint
+	     && viewsignaturevalid
+	     && R_ViewSignature (player, &signature)
+	     && signature == viewsignature;
+
+    if (unchanged && viewcachevalid && viewcache != NULL)
+    {
+	// Menus, messages and the pause pic may have been drawn over it.
+	R_CopyViewCache (true);
+	V_MarkRect (viewwindowx, viewwindowy, scaledviewwidth, viewheight);
+	return;
+    }
+
     R_SetupFrame (player);
 
     // Clear buffers.
@@ -869,6 +1211,7 @@ void R_RenderPlayerView (player_t* player)
     R_ClearDrawSegs ();
     R_ClearPlanes ();
     R_ClearSprites ();
+    numviewsectors = 0;
     
     // check for new console commands.
     NetUpdate ();
@@ -886,6 +1229,28 @@ void R_RenderPlayerView (player_t* player)
     
     R_DrawMasked ();
 
+    R_CountLimits ();
+
+    // The view changes every frame.
+    V_MarkScreen ();
+
+    // Only a view seen twice in a row is cached, so that a moving view
+    //  does not pay for the copy, nor for the hash.
+    viewcachevalid = false;
+
+    if (samepoint && !demoplayback)
+    {
+	viewsignaturevalid = R_ViewSignature (player, &viewsignature);
+    }
+    else
+    {
+	viewpoint = point;
+	viewsignaturevalid = false;
+    }
+
+    if (unchanged && viewsignaturevalid && viewsignature == signature)
+	R_SaveViewCache ();
+
     // Check for new console commands.
     NetUpdate ();				
 }
@@ -49,6 +49,25 @@ extern int		validcount;
 extern int		linecount;
 extern int		loopcount;
 
+// Sectors visited by the last render, for view reuse.
+extern sector_t**	viewsectors;
+extern int		numviewsectors;
+
+//
+// Use of the renderer limits (see MAXVISPLANES).
+//
+typedef struct
+{
+    int		visplanes;
+    int		drawsegs;
+    int		vissprites;
+    int		openings;
+} rendercounts_t;
+
+// Of the last rendered frame, and the peak since the last report.
+extern rendercounts_t	renderframe;
+extern rendercounts_t	renderpeak;
+
 
 //
 // Lighting LUT.
@@ -157,4 +176,16 @@ void R_Init (void);
 // Called by M_Responder.
 void R_SetViewSize (int blocks, int detail);
 
+// Grows the array of a renderer limit.
+void*
+R_GrowLimit
+( void*		array,
+  int*		count,
+  int		size,
+  int		chunk,
+  int		cap );
+
+// Reports the peaks of the renderer limits, and starts over.
+void R_DumpLimits (void);
+
 #endif
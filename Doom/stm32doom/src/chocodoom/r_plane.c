@@ -42,15 +42,39 @@ planefunction_t		ceilingfunc;
 //
 
 // Here comes the obnoxious "visplane".
-#define MAXVISPLANES	128
-visplane_t		visplanes[MAXVISPLANES];
+// numvisplanes are allocated, grown by R_NewPlane.
+visplane_t*		visplanes;
+int			numvisplanes;
 visplane_t*		lastvisplane;
 visplane_t*		floorplane;
 visplane_t*		ceilingplane;
 
-// ?
-#define MAXOPENINGS	SCREENWIDTH*64
-short			openings[MAXOPENINGS];
+// Handed out past MAXVISPLANES, never drawn.
+static visplane_t	overflowplane;
+
+//
+// R_FindPlane looks visplanes up by height, picnum and lightlevel in
+//  an open addressed hash, linearly probed. It holds the first visplane
+//  of each key, the ones R_CheckPlane splits off are never looked up.
+// At least twice the visplanes, so that it never fills up.
+//
+#define VISPLANEHASH(height, picnum, lightlevel) \
+    ((((unsigned) (height) ^ ((unsigned) (picnum) << 8) \
+       ^ (unsigned) (lightlevel)) * 2654435761u) >> (32-visplanehashbits))
+
+static visplane_t**	visplanehash;
+static int		visplanehashbits;
+static int		visplanehashsize;
+
+//
+// Openings come in chunks of the zone, kept from frame to frame.
+// R_ReserveOpenings makes sure the chunk in use has room for a wall
+//  range, which takes its openings from a single chunk.
+//
+static short*		openingchunks[MAXOPENINGS/OPENINGCHUNK];
+static int		numopeningchunks;
+static int		openingchunk;
+static short*		openingsend;
 short*			lastopening;
 
 
@@ -87,13 +111,136 @@ fixed_t			cachedystep[SCREENHEIGHT];
 
 
 
+//
+// R_HashPlanes
+// Sizes the hash to the visplanes and fills it again, the first
+//  visplane of each key first.
+//
+static void R_HashPlanes (void)
+{
+    visplane_t*	pl;
+    visplane_t*	check;
+    unsigned	slot;
+
+    if (visplanehash != NULL)
+	Z_Free (visplanehash);
+
+    for (visplanehashbits = 1 ;
+	 (1 << visplanehashbits) < 2*numvisplanes ;
+	 visplanehashbits++);
+
+    visplanehashsize = 1 << visplanehashbits;
+    visplanehash = Z_Malloc (visplanehashsize*sizeof(*visplanehash),
+			     PU_STATIC, NULL);
+    memset (visplanehash, 0, visplanehashsize*sizeof(*visplanehash));
+
+    for (pl = visplanes ; pl < lastvisplane ; pl++)
+    {
+	slot = VISPLANEHASH(pl->height, pl->picnum, pl->lightlevel);
+
+	while ((check = visplanehash[slot]) != NULL)
+	{
+	    if (pl->height == check->height
+		&& pl->picnum == check->picnum
+		&& pl->lightlevel == check->lightlevel)
+	    {
+		break;
+	    }
+	    slot = (slot+1) & (visplanehashsize-1);
+	}
+
+	if (check == NULL)
+	    visplanehash[slot] = pl;
+    }
+}
+
+
+//
+// R_GrowPlanes
+// Moves the visplanes to a larger array, with the pointers into them.
+//
+static boolean R_GrowPlanes (void)
+{
+    visplane_t*	grown;
+
+    grown = R_GrowLimit (visplanes, &numvisplanes, sizeof(*visplanes),
+			 VISPLANECHUNK, MAXVISPLANES);
+
+    if (grown == NULL)
+	return false;
+
+    if (floorplane >= visplanes && floorplane < lastvisplane)
+	floorplane = grown + (floorplane - visplanes);
+    if (ceilingplane >= visplanes && ceilingplane < lastvisplane)
+	ceilingplane = grown + (ceilingplane - visplanes);
+
+    lastvisplane = grown + (lastvisplane - visplanes);
+    visplanes = grown;
+
+    R_HashPlanes ();
+    return true;
+}
+
+
+//
+// R_NewPlane
+// Past MAXVISPLANES, the overflow plane takes what would not fit.
+//
+static visplane_t* R_NewPlane (void)
+{
+    if (lastvisplane == visplanes + numvisplanes && !R_GrowPlanes ())
+	return &overflowplane;
+
+    return lastvisplane++;
+}
+
+
+//
+// R_ReserveOpenings
+// Returns false past MAXOPENINGS.
+//
+boolean R_ReserveOpenings (int count)
+{
+    if (openingsend - lastopening >= count)
+	return true;
+
+    if (openingchunk+1 == numopeningchunks)
+    {
+	if (numopeningchunks == MAXOPENINGS/OPENINGCHUNK)
+	    return false;
+
+	openingchunks[numopeningchunks++] =
+	    Z_Malloc (OPENINGCHUNK*sizeof(**openingchunks), PU_STATIC, NULL);
+    }
+
+    openingchunk++;
+    lastopening = openingchunks[openingchunk];
+    openingsend = lastopening + OPENINGCHUNK;
+    return true;
+}
+
+
+//
+// R_CountOpenings
+//
+void R_CountOpenings (int* used, int* allocated)
+{
+    *used = 0;
+    if (openingchunk >= 0)
+	*used = openingchunk*OPENINGCHUNK
+	      + (lastopening - openingchunks[openingchunk]);
+    *allocated = numopeningchunks*OPENINGCHUNK;
+}
+
+
 //
 // R_InitPlanes
 // Only at game startup.
 //
 void R_InitPlanes (void)
 {
-  // Doh!
+    lastvisplane = visplanes;
+    R_GrowPlanes ();
 }
 
 
@@ -188,7 +335,10 @@ void R_ClearPlanes (void)
     }
 
     lastvisplane = visplanes;
-    lastopening = openings;
+    memset (visplanehash, 0, visplanehashsize*sizeof(*visplanehash));
+
+    openingchunk = -1;
+    lastopening = openingsend = NULL;
 
     // texture calculation
     memset (cachedheight, 0, sizeof(cachedheight));
@@ -214,6 +364,7 @@ R_FindPlane
   int		lightlevel )
 {
     visplane_t*	check;
+    unsigned	slot;
 
     if (picnum == skyflatnum)
     {
@@ -221,24 +372,29 @@ R_FindPlane
 	lightlevel = 0;
     }
 
-    for (check=visplanes; check<lastvisplane; check++)
+    slot = VISPLANEHASH(height, picnum, lightlevel);
+
+    while ((check = visplanehash[slot]) != NULL)
     {
 	if (height == check->height
 	    && picnum == check->picnum
 	    && lightlevel == check->lightlevel)
 	{
-	    break;
+	    return check;
 	}
+	slot = (slot+1) & (visplanehashsize-1);
     }
 
+    check = R_NewPlane ();
 
-    if (check < lastvisplane)
-	return check;
-
-    if (lastvisplane - visplanes == MAXVISPLANES)
-	I_Error ("R_FindPlane: no more visplanes");
-
-    lastvisplane++;
+    // the hash may have been sized anew
+    if (check != &overflowplane)
+    {
+	slot = VISPLANEHASH(height, picnum, lightlevel);
+	while (visplanehash[slot] != NULL)
+	    slot = (slot+1) & (visplanehashsize-1);
+	visplanehash[slot] = check;
+    }
 
     check->height = height;
     check->picnum = picnum;
@@ -266,6 +422,9 @@ R_CheckPlane
     int		unionl;
     int		unionh;
     int		x;
+    fixed_t	height;
+    int		picnum;
+    int		lightlevel;
 
     if (start < pl->minx)
     {
@@ -302,12 +461,15 @@ R_CheckPlane
 	return pl;
     }
 
-    // make a new visplane
-    lastvisplane->height = pl->height;
-    lastvisplane->picnum = pl->picnum;
-    lastvisplane->lightlevel = pl->lightlevel;
+    // make a new visplane, which may move the visplanes
+    height = pl->height;
+    picnum = pl->picnum;
+    lightlevel = pl->lightlevel;
 
-    pl = lastvisplane++;
+    pl = R_NewPlane ();
+    pl->height = height;
+    pl->picnum = picnum;
+    pl->lightlevel = lightlevel;
     pl->minx = start;
     pl->maxx = stop;
 
@@ -367,17 +529,17 @@ void R_DrawPlanes (void)
     int                 lumpnum;
 
 #ifdef RANGECHECK
-    if (ds_p - drawsegs > MAXDRAWSEGS)
+    if (ds_p - drawsegs > numdrawsegs)
 	I_Error ("R_DrawPlanes: drawsegs overflow (%i)",
 		 ds_p - drawsegs);
 
-    if (lastvisplane - visplanes > MAXVISPLANES)
+    if (lastvisplane - visplanes > numvisplanes)
 	I_Error ("R_DrawPlanes: visplane overflow (%i)",
 		 lastvisplane - visplanes);
 
-    if (lastopening - openings > MAXOPENINGS)
+    if (lastopening > openingsend)
 	I_Error ("R_DrawPlanes: opening overflow (%i)",
-		 lastopening - openings);
+		 lastopening - openingsend);
 #endif
 
     for (pl = visplanes ; pl < lastvisplane ; pl++)
@@ -405,11 +567,12 @@ void R_DrawPlanes (void)
 		if (dc_yl <= dc_yh)
 		{
 		    angle = (viewangle + xtoviewangle[x])>>ANGLETOSKYSHIFT;
-		    dc_x = x;
-		    dc_source = R_GetColumn(skytexture, angle);
-		    colfunc ();
+		    R_QueueColumn (R_GetColumn(skytexture, angle), dc_colormap,
+				   x, dc_yl, dc_yh, dc_iscale, dc_texturemid,
+				   COLUMNHEIGHT);
 		}
 	    }
+	    R_FlushColumns ();
 	    continue;
 	}
 
@@ -28,6 +28,10 @@
 // Visplane related.
 extern  short*		lastopening;
 
+extern visplane_t*	visplanes;
+extern int		numvisplanes;
+extern visplane_t*	lastvisplane;
+
 
 typedef void (*planefunction_t) (int top, int bottom);
 
@@ -71,6 +75,9 @@ R_CheckPlane
   int		start,
   int		stop );
 
+boolean R_ReserveOpenings (int count);
+void R_CountOpenings (int* used, int* allocated);
+
 
 
 #endif
@@ -47,6 +47,11 @@ int		toptexture;
 int		bottomtexture;
 int		midtexture;
 
+// Heights at which the wall textures wrap, picking their drawers.
+static int	topheight;
+static int	bottomheight;
+static int	midheight;
+
 
 angle_t		rw_normalangle;
 // angle to line origin
@@ -89,6 +94,21 @@ short*		maskedtexturecol;
 
 
 
+//
+// R_ColumnHeight
+// The height at which the rows of a wall texture repeat.
+//
+static int R_ColumnHeight (int texnum)
+{
+#ifdef FEATURE_TALL_TEXTURES
+    return textureheight[texnum]>>FRACBITS;
+#else
+    return COLUMNHEIGHT;
+#endif
+}
+
+
+
 //
 // R_RenderMaskedSegRange
 //
@@ -179,7 +199,8 @@ R_RenderMaskedSegRange
 	}
 	spryscale += rw_scalestep;
     }
-	
+
+    R_FlushColumns ();
 }
 
 
@@ -256,13 +277,18 @@ void R_RenderSegLoop (void)
 	    angle = (rw_centerangle + xtoviewangle[rw_x])>>ANGLETOFINESHIFT;
 	    texturecolumn = rw_offset-FixedMul(finetangent[angle],rw_distance);
 	    texturecolumn >>= FRACBITS;
-	    // calculate lighting
-	    index = rw_scale>>LIGHTSCALESHIFT;
+	    // calculate lighting, constant with a fixed colormap
+	    if (fixedcolormap)
+		dc_colormap = fixedcolormap;
+	    else
+	    {
+		index = rw_scale>>LIGHTSCALESHIFT;
 
-	    if (index >=  MAXLIGHTSCALE )
-		index = MAXLIGHTSCALE-1;
+		if (index >=  MAXLIGHTSCALE )
+		    index = MAXLIGHTSCALE-1;
 
-	    dc_colormap = walllights[index];
+		dc_colormap = walllights[index];
+	    }
 	    dc_x = rw_x;
 	    dc_iscale = 0xffffffffu / (unsigned)rw_scale;
 	}
@@ -277,11 +303,8 @@ void R_RenderSegLoop (void)
 	if (midtexture)
 	{
 	    // single sided line
-	    dc_yl = yl;
-	    dc_yh = yh;
-	    dc_texturemid = rw_midtexturemid;
-	    dc_source = R_GetColumn(midtexture,texturecolumn);
-	    colfunc ();
+	    R_QueueColumn (R_GetColumn(midtexture,texturecolumn), dc_colormap,
+			   rw_x, yl, yh, dc_iscale, rw_midtexturemid, midheight);
 	    ceilingclip[rw_x] = viewheight;
 	    floorclip[rw_x] = -1;
 	}
@@ -299,11 +322,8 @@ void R_RenderSegLoop (void)
 
 		if (mid >= yl)
 		{
-		    dc_yl = yl;
-		    dc_yh = mid;
-		    dc_texturemid = rw_toptexturemid;
-		    dc_source = R_GetColumn(toptexture,texturecolumn);
-		    colfunc ();
+		    R_QueueColumn (R_GetColumn(toptexture,texturecolumn), dc_colormap,
+				   rw_x, yl, mid, dc_iscale, rw_toptexturemid, topheight);
 		    ceilingclip[rw_x] = mid;
 		}
 		else
@@ -328,12 +348,9 @@ void R_RenderSegLoop (void)
 		
 		if (mid <= yh)
 		{
-		    dc_yl = mid;
-		    dc_yh = yh;
-		    dc_texturemid = rw_bottomtexturemid;
-		    dc_source = R_GetColumn(bottomtexture,
-					    texturecolumn);
-		    colfunc ();
+		    R_QueueColumn (R_GetColumn(bottomtexture,texturecolumn), dc_colormap,
+				   rw_x, mid, yh, dc_iscale, rw_bottomtexturemid,
+				   bottomheight);
 		    floorclip[rw_x] = mid;
 		}
 		else
@@ -358,6 +375,8 @@ void R_RenderSegLoop (void)
 	topfrac += topstep;
 	bottomfrac += bottomstep;
     }
+
+    R_FlushColumns ();
 }
 
 
@@ -380,8 +399,12 @@ R_StoreWallRange
     int			lightnum;
 
     // don't overflow and crash
-    if (ds_p == &drawsegs[MAXDRAWSEGS])
+    if (ds_p == drawsegs + numdrawsegs && !R_GrowDrawSegs ())
 	return;		
+
+    // masked texture columns and the two sprite clips at most
+    if (!R_ReserveOpenings (3*(stop-start+1)))
+	return;
 		
 #ifdef RANGECHECK
     if (start >=viewwidth || start > stop)
@@ -701,6 +724,11 @@ R_StoreWallRange
 	}
     }
     
+    // pick the column drawers of the wall tiers
+    topheight = R_ColumnHeight (toptexture);
+    bottomheight = R_ColumnHeight (bottomtexture);
+    midheight = R_ColumnHeight (midtexture);
+
     // render it
     if (markceiling)
 	ceilingplane = R_CheckPlane (ceilingplane, rw_x, rw_stopx-1);
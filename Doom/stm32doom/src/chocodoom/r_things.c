@@ -278,7 +278,9 @@ void R_InitSpriteDefs (char** namelist)
 //
 // GAME FUNCTIONS
 //
-vissprite_t	vissprites[MAXVISSPRITES];
+// numvissprites are allocated, grown by R_NewVisSprite.
+vissprite_t*	vissprites;
+int		numvissprites;
 vissprite_t*	vissprite_p;
 int		newvissprite;
 
@@ -319,8 +321,19 @@ vissprite_t	overflowsprite;
 
 vissprite_t* R_NewVisSprite (void)
 {
-    if (vissprite_p == &vissprites[MAXVISSPRITES])
-	return &overflowsprite;
+    vissprite_t*	grown;
+
+    if (vissprite_p == vissprites + numvissprites)
+    {
+	grown = R_GrowLimit (vissprites, &numvissprites, sizeof(*vissprites),
+			     VISSPRITECHUNK, MAXVISSPRITES);
+
+	if (grown == NULL)
+	    return &overflowsprite;
+
+	vissprite_p = grown + (vissprite_p - vissprites);
+	vissprites = grown;
+    }
     
     vissprite_p++;
     return vissprite_p-1;
@@ -369,9 +382,13 @@ void R_DrawMaskedColumn (column_t* column)
 	    dc_texturemid = basetexturemid - (column->topdelta<<FRACBITS);
 	    // dc_source = (byte *)column + 3 - column->topdelta;
 
-	    // Drawn by either R_DrawColumn
-	    //  or (SHADOW) R_DrawFuzzColumn.
-	    colfunc ();	
+	    // Plain columns are queued, the fuzz and translation
+	    //  effects are drawn right away.
+	    if (colfunc == basecolfunc)
+		R_QueueColumn (dc_source, dc_colormap, dc_x, dc_yl, dc_yh,
+			       dc_iscale, dc_texturemid, COLUMNHEIGHT);
+	    else
+		colfunc ();	
 	}
 	column = (column_t *)(  (byte *)column + column->length + 4);
     }
@@ -431,6 +448,7 @@ R_DrawVisSprite
 	R_DrawMaskedColumn (column);
     }
 
+    R_FlushColumns ();
     colfunc = basecolfunc;
 }
 
@@ -616,6 +634,9 @@ void R_AddSprites (sector_t* sec)
 
     // Well, now it will be done.
     sec->validcount = validcount;
+
+    if (numviewsectors < numsectors)
+	viewsectors[numviewsectors++] = sec;
 	
     lightnum = (sec->lightlevel >> LIGHTSEGSHIFT)+extralight;
 
@@ -770,8 +791,44 @@ void R_DrawPlayerSprites (void)
 
 
 
+//
+// R_MergeVisSprites
+// Merges two NULL terminated lists sorted by scale.
+// Sprites of list a come before those of list b
+// on equal scale, which keeps the sort stable.
+//
+static vissprite_t* R_MergeVisSprites (vissprite_t* a, vissprite_t* b)
+{
+    vissprite_t		head;
+    vissprite_t*	tail;
+
+    tail = &head;
+
+    while (a && b)
+    {
+	if (b->scale < a->scale)
+	{
+	    tail->next = b;
+	    b = b->next;
+	}
+	else
+	{
+	    tail->next = a;
+	    a = a->next;
+	}
+	tail = tail->next;
+    }
+    tail->next = a ? a : b;
+
+    return head.next;
+}
+
+
 //
 // R_SortVisSprites
+// Stable merge sort on scale, back to front.
+// Sprites of equal scale keep the order they were
+// added in, the same as the original selection sort.
 //
 vissprite_t	vsprsortedhead;
 
@@ -779,51 +836,119 @@ vissprite_t	vsprsortedhead;
 void R_SortVisSprites (void)
 {
     int			i;
-    int			count;
     vissprite_t*	ds;
-    vissprite_t*	best;
-    vissprite_t		unsorted;
-    fixed_t		bestscale;
+    vissprite_t*	carry;
+    vissprite_t*	prev;
+    // lists[i] holds 2^i sprites, or is empty;
+    //  higher indices hold the earlier sprites
+    vissprite_t*	lists[32];
 
-    count = vissprite_p - vissprites;
-	
-    unsorted.next = unsorted.prev = &unsorted;
+    vsprsortedhead.next = vsprsortedhead.prev = &vsprsortedhead;
 
-    if (!count)
+    if (vissprite_p == vissprites)
 	return;
-		
+
+    memset (lists, 0, sizeof(lists));
+
     for (ds=vissprites ; ds<vissprite_p ; ds++)
     {
-	ds->next = ds+1;
-	ds->prev = ds-1;
-    }
-    
-    vissprites[0].prev = &unsorted;
-    unsorted.next = &vissprites[0];
-    (vissprite_p-1)->next = &unsorted;
-    unsorted.prev = vissprite_p-1;
-    
-    // pull the vissprites out by scale
+	ds->next = NULL;
+	carry = ds;
 
-    vsprsortedhead.next = vsprsortedhead.prev = &vsprsortedhead;
-    for (i=0 ; i<count ; i++)
-    {
-	bestscale = INT_MAX;
-        best = unsorted.next;
-	for (ds=unsorted.next ; ds!= &unsorted ; ds=ds->next)
+	for (i=0 ; lists[i] ; i++)
 	{
-	    if (ds->scale < bestscale)
-	    {
-		bestscale = ds->scale;
-		best = ds;
-	    }
+	    carry = R_MergeVisSprites (lists[i], carry);
+	    lists[i] = NULL;
 	}
-	best->next->prev = best->prev;
-	best->prev->next = best->next;
-	best->next = &vsprsortedhead;
-	best->prev = vsprsortedhead.prev;
-	vsprsortedhead.prev->next = best;
-	vsprsortedhead.prev = best;
+	lists[i] = carry;
+    }
+
+    carry = NULL;
+    for (i=0 ; i<32 ; i++)
+    {
+	if (lists[i])
+	    carry = R_MergeVisSprites (lists[i], carry);
+    }
+
+    // link the sorted sprites back into a ring
+    prev = &vsprsortedhead;
+    for (ds=carry ; ds ; ds=ds->next)
+    {
+	ds->prev = prev;
+	prev->next = ds;
+	prev = ds;
+    }
+    prev->next = &vsprsortedhead;
+    vsprsortedhead.prev = prev;
+}
+
+
+
+//
+// Drawseg buckets.
+// The drawsegs that can clip sprites, indexed by
+//  the screen columns they cover, so that a sprite
+//  only scans the drawsegs overlapping it.
+// Each bucket lists its drawsegs from end to start,
+//  the order R_DrawSprite has to scan them in.
+//
+#define BUCKETSHIFT		5
+#define NUMBUCKETS		((SCREENWIDTH+(1<<BUCKETSHIFT)-1)>>BUCKETSHIFT)
+
+static drawseg_t**	bucketsegs;
+static int		numbucketsegs;
+static int		bucketstart[NUMBUCKETS+1];
+
+
+//
+// R_BucketDrawSegs
+// Once per frame, after the BSP traversal.
+//
+static void R_BucketDrawSegs (void)
+{
+    drawseg_t*		ds;
+    drawseg_t**		grown;
+    int			fill[NUMBUCKETS];
+    int			b;
+    int			total;
+
+    memset (fill, 0, sizeof(fill));
+
+    for (ds=drawsegs ; ds<ds_p ; ds++)
+    {
+	if (!ds->silhouette && !ds->maskedtexturecol)
+	    continue;
+
+	for (b = ds->x1>>BUCKETSHIFT ; b <= ds->x2>>BUCKETSHIFT ; b++)
+	    fill[b]++;
+    }
+
+    total = 0;
+    for (b=0 ; b<NUMBUCKETS ; b++)
+    {
+	bucketstart[b] = total;
+	total += fill[b];
+	fill[b] = bucketstart[b];
+    }
+    bucketstart[NUMBUCKETS] = total;
+
+    // a drawseg is in at most all buckets, so this never hits the cap
+    while (numbucketsegs < total)
+    {
+	grown = R_GrowLimit (bucketsegs, &numbucketsegs, sizeof(*bucketsegs),
+			     DRAWSEGCHUNK, MAXDRAWSEGS*NUMBUCKETS);
+	if (grown == NULL)
+	    I_Error ("R_BucketDrawSegs: %i bucket entries", total);
+	bucketsegs = grown;
+    }
+
+    for (ds=ds_p-1 ; ds >= drawsegs ; ds--)
+    {
+	if (!ds->silhouette && !ds->maskedtexturecol)
+	    continue;
+
+	for (b = ds->x1>>BUCKETSHIFT ; b <= ds->x2>>BUCKETSHIFT ; b++)
+	    bucketsegs[fill[b]++] = ds;
     }
 }
 
@@ -840,6 +965,10 @@ void R_DrawSprite (vissprite_t* spr)
     int			x;
     int			r1;
     int			r2;
+    int			b;
+    int			bx1;
+    int			bx2;
+    int			i;
     fixed_t		scale;
     fixed_t		lowscale;
     int			silhouette;
@@ -850,79 +979,92 @@ void R_DrawSprite (vissprite_t* spr)
     // Scan drawsegs from end to start for obscuring segs.
     // The first drawseg that has a greater scale
     //  is the clip seg.
-    for (ds=ds_p-1 ; ds >= drawsegs ; ds--)
+    // This is done bucket by bucket: all the work is
+    //  per column, and the columns of a bucket still
+    //  see their drawsegs in the same order.
+    for (b = spr->x1>>BUCKETSHIFT ; b <= spr->x2>>BUCKETSHIFT ; b++)
     {
-	// determine if the drawseg obscures the sprite
-	if (ds->x1 > spr->x2
-	    || ds->x2 < spr->x1
-	    || (!ds->silhouette
-		&& !ds->maskedtexturecol) )
+	bx1 = b<<BUCKETSHIFT;
+	bx2 = bx1 + (1<<BUCKETSHIFT) - 1;
+	if (bx1 < spr->x1)
+	    bx1 = spr->x1;
+	if (bx2 > spr->x2)
+	    bx2 = spr->x2;
+
+	for (i = bucketstart[b] ; i < bucketstart[b+1] ; i++)
 	{
-	    // does not cover sprite
-	    continue;
-	}
+	    ds = bucketsegs[i];
+
+	    // determine if the drawseg obscures the sprite
+	    if (ds->x1 > bx2
+		|| ds->x2 < bx1)
+	    {
+		// does not cover sprite
+		continue;
+	    }
 			
-	r1 = ds->x1 < spr->x1 ? spr->x1 : ds->x1;
-	r2 = ds->x2 > spr->x2 ? spr->x2 : ds->x2;
+	    r1 = ds->x1 < bx1 ? bx1 : ds->x1;
+	    r2 = ds->x2 > bx2 ? bx2 : ds->x2;
 
-	if (ds->scale1 > ds->scale2)
-	{
-	    lowscale = ds->scale2;
-	    scale = ds->scale1;
-	}
-	else
-	{
-	    lowscale = ds->scale1;
-	    scale = ds->scale2;
-	}
+	    if (ds->scale1 > ds->scale2)
+	    {
+		lowscale = ds->scale2;
+		scale = ds->scale1;
+	    }
+	    else
+	    {
+		lowscale = ds->scale1;
+		scale = ds->scale2;
+	    }
 		
-	if (scale < spr->scale
-	    || ( lowscale < spr->scale
-		 && !R_PointOnSegSide (spr->gx, spr->gy, ds->curline) ) )
-	{
-	    // masked mid texture?
-	    if (ds->maskedtexturecol)	
-		R_RenderMaskedSegRange (ds, r1, r2);
-	    // seg is behind sprite
-	    continue;			
-	}
+	    if (scale < spr->scale
+		|| ( lowscale < spr->scale
+		     && !R_PointOnSegSide (spr->gx, spr->gy, ds->curline) ) )
+	    {
+		// masked mid texture?
+		if (ds->maskedtexturecol)
+		    R_RenderMaskedSegRange (ds, r1, r2);
+		// seg is behind sprite
+		continue;
+	    }
 
 	
-	// clip this piece of the sprite
-	silhouette = ds->silhouette;
+	    // clip this piece of the sprite
+	    silhouette = ds->silhouette;
 	
-	if (spr->gz >= ds->bsilheight)
-	    silhouette &= ~SIL_BOTTOM;
+	    if (spr->gz >= ds->bsilheight)
+		silhouette &= ~SIL_BOTTOM;
 
-	if (spr->gzt <= ds->tsilheight)
-	    silhouette &= ~SIL_TOP;
+	    if (spr->gzt <= ds->tsilheight)
+		silhouette &= ~SIL_TOP;
 			
-	if (silhouette == 1)
-	{
-	    // bottom sil
-	    for (x=r1 ; x<=r2 ; x++)
-		if (clipbot[x] == -2)
-		    clipbot[x] = ds->sprbottomclip[x];
-	}
-	else if (silhouette == 2)
-	{
-	    // top sil
-	    for (x=r1 ; x<=r2 ; x++)
-		if (cliptop[x] == -2)
-		    cliptop[x] = ds->sprtopclip[x];
-	}
-	else if (silhouette == 3)
-	{
-	    // both
-	    for (x=r1 ; x<=r2 ; x++)
+	    if (silhouette == 1)
 	    {
-		if (clipbot[x] == -2)
-		    clipbot[x] = ds->sprbottomclip[x];
-		if (cliptop[x] == -2)
-		    cliptop[x] = ds->sprtopclip[x];
+		// bottom sil
+		for (x=r1 ; x<=r2 ; x++)
+		    if (clipbot[x] == -2)
+			clipbot[x] = ds->sprbottomclip[x];
+	    }
+	    else if (silhouette == 2)
+	    {
+		// top sil
+		for (x=r1 ; x<=r2 ; x++)
+		    if (cliptop[x] == -2)
+			cliptop[x] = ds->sprtopclip[x];
+	    }
+	    else if (silhouette == 3)
+	    {
+		// both
+		for (x=r1 ; x<=r2 ; x++)
+		{
+		    if (clipbot[x] == -2)
+			clipbot[x] = ds->sprbottomclip[x];
+		    if (cliptop[x] == -2)
+			cliptop[x] = ds->sprtopclip[x];
+		}
 	    }
-	}
 		
+	}
     }
     
     // all clipping has been performed, so draw the sprite
@@ -957,6 +1099,8 @@ void R_DrawMasked (void)
 
     if (vissprite_p > vissprites)
     {
+	R_BucketDrawSegs ();
+
 	// draw all vissprites back to front
 	for (spr = vsprsortedhead.next ;
 	     spr != &vsprsortedhead ;
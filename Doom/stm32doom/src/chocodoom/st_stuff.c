@@ -260,7 +260,7 @@
 #define ST_MAPHEIGHT		1
 
 // graphics are drawn to a backing screen and blitted to the real screen
-byte                   *st_backing_screen;
+pixel_t                *st_backing_screen;
 	    
 // main player in game
 static player_t*	plyr; 
@@ -994,6 +994,10 @@ void ST_doPaletteStuff(void)
 	st_palette = palette;
 	pal = (byte *) W_CacheLumpNum (lu_palette, PU_CACHE)+palette*768;
 	I_SetPalette (pal);
+#ifdef FEATURE_RGB565_VIDEO
+	// the backing screen holds pixels of the old palette
+	st_firsttime = true;
+#endif
     }
 
 }
@@ -1411,6 +1415,11 @@ void ST_Stop (void)
 void ST_Init (void)
 {
     ST_loadData();
+#ifdef FEATURE_COLUMN_MAJOR_VIDEO
+    // Screen sized, as the columns are SCREENHEIGHT long.
+    st_backing_screen = (pixel_t *) Z_Malloc(SCREENWIDTH * SCREENHEIGHT * sizeof(pixel_t), PU_STATIC, 0);
+#else
     st_backing_screen = (byte *) Z_Malloc(ST_WIDTH * ST_HEIGHT, PU_STATIC, 0);
+#endif
 }
 
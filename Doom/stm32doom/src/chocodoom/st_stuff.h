@@ -22,6 +22,7 @@
 #define __STSTUFF_H__
 
 #include "doomtype.h"
+#include "i_video.h"
 #include "d_event.h"
 #include "m_cheat.h"
 
@@ -73,7 +74,7 @@ typedef enum
 
 
 
-extern byte *st_backing_screen;
+extern pixel_t *st_backing_screen;
 extern cheatseq_t cheat_mus;
 extern cheatseq_t cheat_god;
 extern cheatseq_t cheat_ammo;
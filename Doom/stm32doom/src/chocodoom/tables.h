@@ -89,7 +89,27 @@ extern const angle_t tantoangle[SLOPERANGE+1];
 
 // Utility function,
 //  called by R_PointToAngle.
-int SlopeDiv(unsigned int num, unsigned int den);
+// To get a global angle from cartesian coordinates, the coordinates are
+// flipped until they are in the first octant of the coordinate system, then
+// the y (<=x) is scaled and divided by x to get a tangent (slope) value
+// which is looked up in the tantoangle[] table.
+// Inline, as it is called for both ends of every seg:
+//  the division is a single UDIV on the Cortex-M4.
+static inline int SlopeDiv(unsigned int num, unsigned int den)
+{
+    unsigned ans;
+
+    if (den < 512)
+    {
+        return SLOPERANGE;
+    }
+    else
+    {
+        ans = (num << 3) / (den >> 8);
+
+        return ans <= SLOPERANGE ? ans : SLOPERANGE;
+    }
+}
 
 
 #endif
@@ -55,14 +55,48 @@ byte *xlatab = NULL;
 
 // The screen buffer that the v_video.c code draws to.
 
-static byte *dest_screen = NULL;
+static pixel_t *dest_screen = NULL;
 
 int dirtybox[4]; 
 
+uint32_t dirtytiles[DIRTYTILECOLS];
+boolean dirtyscreen;
+
 // haleyjd 08/28/10: clipping callback function for patches.
 // This is needed for Chocolate Strife, which clips patches to the screen.
 static vpatchclipfunc_t patchclip_callback = NULL;
 
+//
+// V_MarkTiles
+// Marks the tiles covered by a rectangle.
+//
+static void V_MarkTiles(int x, int y, int width, int height)
+{
+    int x1 = x + width - 1;
+    int y1 = y + height - 1;
+    uint32_t rows;
+
+    if (x < 0)
+        x = 0;
+    if (y < 0)
+        y = 0;
+    if (x1 >= SCREENWIDTH)
+        x1 = SCREENWIDTH - 1;
+    if (y1 >= SCREENHEIGHT)
+        y1 = SCREENHEIGHT - 1;
+    if (x > x1 || y > y1)
+        return;
+
+    y /= DIRTYTILEHEIGHT;
+    y1 /= DIRTYTILEHEIGHT;
+    rows = (((uint32_t) 2 << y1) - 1) & ~(((uint32_t) 1 << y) - 1);
+
+    for (x /= DIRTYTILEWIDTH; x <= x1 / DIRTYTILEWIDTH; x++)
+    {
+        dirtytiles[x] |= rows;
+    }
+}
+
 //
 // V_MarkRect 
 // 
@@ -75,19 +109,33 @@ void V_MarkRect(int x, int y, int width, int height)
     {
         M_AddToBox (dirtybox, x, y); 
         M_AddToBox (dirtybox, x + width-1, y + height-1); 
+        V_MarkTiles (x, y, width, height);
     }
 } 
+
+//
+// V_MarkScreen
+// Marks the whole screen as changed, without it being compared with
+// the previous frame when presented.
+//
+void V_MarkScreen(void)
+{
+    if (dest_screen == I_VideoBuffer)
+    {
+        dirtyscreen = true;
+    }
+}
  
 
 //
 // V_CopyRect 
 // 
-void V_CopyRect(int srcx, int srcy, byte *source,
+void V_CopyRect(int srcx, int srcy, pixel_t *source,
                 int width, int height,
                 int destx, int desty)
 { 
-    byte *src;
-    byte *dest; 
+    pixel_t *src;
+    pixel_t *dest; 
  
 #ifdef RANGECHECK 
     if (srcx < 0
@@ -105,6 +153,18 @@ void V_CopyRect(int srcx, int srcy, byte *source,
 
     V_MarkRect(destx, desty, width, height); 
  
+#ifdef FEATURE_COLUMN_MAJOR_VIDEO
+    // Columns are contiguous, from the bottom up.
+    src = source + SCREENOFFSET(srcx, srcy + height - 1); 
+    dest = dest_screen + SCREENOFFSET(destx, desty + height - 1); 
+
+    for ( ; width>0 ; width--) 
+    { 
+        memcpy(dest, src, height * sizeof(pixel_t)); 
+        src += SCREENPITCH_X; 
+        dest += SCREENPITCH_X; 
+    } 
+#else
     src = source + SCREENWIDTH * srcy + srcx; 
     dest = dest_screen + SCREENWIDTH * desty + destx; 
 
@@ -114,6 +174,7 @@ void V_CopyRect(int srcx, int srcy, byte *source,
         src += SCREENWIDTH; 
         dest += SCREENWIDTH; 
     } 
+#endif
 } 
  
 //
@@ -141,8 +202,8 @@ void V_DrawPatch(int x, int y, patch_t *patch)
     int count;
     int col;
     column_t *column;
-    byte *desttop;
-    byte *dest;
+    pixel_t *desttop;
+    pixel_t *dest;
     byte *source;
     int w;
 
@@ -169,11 +230,11 @@ void V_DrawPatch(int x, int y, patch_t *patch)
     V_MarkRect(x, y, SHORT(patch->width), SHORT(patch->height));
 
     col = 0;
-    desttop = dest_screen + y * SCREENWIDTH + x;
+    desttop = dest_screen + SCREENOFFSET(x, y);
 
     w = SHORT(patch->width);
 
-    for ( ; col<w ; x++, col++, desttop++)
+    for ( ; col<w ; x++, col++, desttop += SCREENPITCH_X)
     {
         column = (column_t *)((byte *)patch + LONG(patch->columnofs[col]));
 
@@ -181,13 +242,13 @@ void V_DrawPatch(int x, int y, patch_t *patch)
         while (column->topdelta != 0xff)
         {
             source = (byte *)column + 3;
-            dest = desttop + column->topdelta*SCREENWIDTH;
+            dest = desttop + column->topdelta * SCREENPITCH_Y;
             count = column->length;
 
             while (count--)
             {
-                *dest = *source++;
-                dest += SCREENWIDTH;
+                *dest = I_PIXEL(*source++);
+                dest += SCREENPITCH_Y;
             }
             column = (column_t *)((byte *)column + column->length + 4);
         }
@@ -205,8 +266,8 @@ void V_DrawPatchFlipped(int x, int y, patch_t *patch)
     int count;
     int col; 
     column_t *column; 
-    byte *desttop;
-    byte *dest;
+    pixel_t *desttop;
+    pixel_t *dest;
     byte *source; 
     int w; 
  
@@ -233,11 +294,11 @@ void V_DrawPatchFlipped(int x, int y, patch_t *patch)
     V_MarkRect (x, y, SHORT(patch->width), SHORT(patch->height));
 
     col = 0;
-    desttop = dest_screen + y * SCREENWIDTH + x;
+    desttop = dest_screen + SCREENOFFSET(x, y);
 
     w = SHORT(patch->width);
 
-    for ( ; col<w ; x++, col++, desttop++)
+    for ( ; col<w ; x++, col++, desttop += SCREENPITCH_X)
     {
         column = (column_t *)((byte *)patch + LONG(patch->columnofs[w-1-col]));
 
@@ -245,13 +306,13 @@ void V_DrawPatchFlipped(int x, int y, patch_t *patch)
         while (column->topdelta != 0xff )
         {
             source = (byte *)column + 3;
-            dest = desttop + column->topdelta*SCREENWIDTH;
+            dest = desttop + column->topdelta * SCREENPITCH_Y;
             count = column->length;
 
             while (count--)
             {
-                *dest = *source++;
-                dest += SCREENWIDTH;
+                *dest = I_PIXEL(*source++);
+                dest += SCREENPITCH_Y;
             }
             column = (column_t *)((byte *)column + column->length + 4);
         }
@@ -280,9 +341,16 @@ void V_DrawTLPatch(int x, int y, patch_t * patch)
 {
     int count, col;
     column_t *column;
-    byte *desttop, *dest, *source;
+    pixel_t *desttop, *dest;
+    byte *source;
     int w;
 
+#ifdef FEATURE_RGB565_VIDEO
+    // The translucency tables map palette indices, not pixels.
+    V_DrawPatch(x, y, patch);
+    return;
+#endif
+
     y -= SHORT(patch->topoffset);
     x -= SHORT(patch->leftoffset);
 
@@ -294,11 +362,13 @@ void V_DrawTLPatch(int x, int y, patch_t * patch)
         I_Error("Bad V_DrawTLPatch");
     }
 
+    V_MarkRect (x, y, SHORT(patch->width), SHORT(patch->height));
+
     col = 0;
-    desttop = dest_screen + y * SCREENWIDTH + x;
+    desttop = dest_screen + SCREENOFFSET(x, y);
 
     w = SHORT(patch->width);
-    for (; col < w; x++, col++, desttop++)
+    for (; col < w; x++, col++, desttop += SCREENPITCH_X)
     {
         column = (column_t *) ((byte *) patch + LONG(patch->columnofs[col]));
 
@@ -307,13 +377,13 @@ void V_DrawTLPatch(int x, int y, patch_t * patch)
         while (column->topdelta != 0xff)
         {
             source = (byte *) column + 3;
-            dest = desttop + column->topdelta * SCREENWIDTH;
+            dest = desttop + column->topdelta * SCREENPITCH_Y;
             count = column->length;
 
             while (count--)
             {
                 *dest = tinttable[((*dest) << 8) + *source++];
-                dest += SCREENWIDTH;
+                dest += SCREENPITCH_Y;
             }
             column = (column_t *) ((byte *) column + column->length + 4);
         }
@@ -330,9 +400,16 @@ void V_DrawXlaPatch(int x, int y, patch_t * patch)
 {
     int count, col;
     column_t *column;
-    byte *desttop, *dest, *source;
+    pixel_t *desttop, *dest;
+    byte *source;
     int w;
 
+#ifdef FEATURE_RGB565_VIDEO
+    // The translucency tables map palette indices, not pixels.
+    V_DrawPatch(x, y, patch);
+    return;
+#endif
+
     y -= SHORT(patch->topoffset);
     x -= SHORT(patch->leftoffset);
 
@@ -342,11 +419,13 @@ void V_DrawXlaPatch(int x, int y, patch_t * patch)
             return;
     }
 
+    V_MarkRect (x, y, SHORT(patch->width), SHORT(patch->height));
+
     col = 0;
-    desttop = dest_screen + y * SCREENWIDTH + x;
+    desttop = dest_screen + SCREENOFFSET(x, y);
 
     w = SHORT(patch->width);
-    for(; col < w; x++, col++, desttop++)
+    for(; col < w; x++, col++, desttop += SCREENPITCH_X)
     {
         column = (column_t *) ((byte *) patch + LONG(patch->columnofs[col]));
 
@@ -355,14 +434,14 @@ void V_DrawXlaPatch(int x, int y, patch_t * patch)
         while(column->topdelta != 0xff)
         {
             source = (byte *) column + 3;
-            dest = desttop + column->topdelta * SCREENWIDTH;
+            dest = desttop + column->topdelta * SCREENPITCH_Y;
             count = column->length;
 
             while(count--)
             {
                 *dest = xlatab[*dest + ((*source) << 8)];
                 source++;
-                dest += SCREENWIDTH;
+                dest += SCREENPITCH_Y;
             }
             column = (column_t *) ((byte *) column + column->length + 4);
         }
@@ -379,9 +458,16 @@ void V_DrawAltTLPatch(int x, int y, patch_t * patch)
 {
     int count, col;
     column_t *column;
-    byte *desttop, *dest, *source;
+    pixel_t *desttop, *dest;
+    byte *source;
     int w;
 
+#ifdef FEATURE_RGB565_VIDEO
+    // The translucency tables map palette indices, not pixels.
+    V_DrawPatch(x, y, patch);
+    return;
+#endif
+
     y -= SHORT(patch->topoffset);
     x -= SHORT(patch->leftoffset);
 
@@ -393,11 +479,13 @@ void V_DrawAltTLPatch(int x, int y, patch_t * patch)
         I_Error("Bad V_DrawAltTLPatch");
     }
 
+    V_MarkRect (x, y, SHORT(patch->width), SHORT(patch->height));
+
     col = 0;
-    desttop = dest_screen + y * SCREENWIDTH + x;
+    desttop = dest_screen + SCREENOFFSET(x, y);
 
     w = SHORT(patch->width);
-    for (; col < w; x++, col++, desttop++)
+    for (; col < w; x++, col++, desttop += SCREENPITCH_X)
     {
         column = (column_t *) ((byte *) patch + LONG(patch->columnofs[col]));
 
@@ -406,13 +494,13 @@ void V_DrawAltTLPatch(int x, int y, patch_t * patch)
         while (column->topdelta != 0xff)
         {
             source = (byte *) column + 3;
-            dest = desttop + column->topdelta * SCREENWIDTH;
+            dest = desttop + column->topdelta * SCREENPITCH_Y;
             count = column->length;
 
             while (count--)
             {
                 *dest = tinttable[((*dest) << 8) + *source++];
-                dest += SCREENWIDTH;
+                dest += SCREENPITCH_Y;
             }
             column = (column_t *) ((byte *) column + column->length + 4);
         }
@@ -429,10 +517,17 @@ void V_DrawShadowedPatch(int x, int y, patch_t *patch)
 {
     int count, col;
     column_t *column;
-    byte *desttop, *dest, *source;
-    byte *desttop2, *dest2;
+    pixel_t *desttop, *dest;
+    byte *source;
+    pixel_t *desttop2, *dest2;
     int w;
 
+#ifdef FEATURE_RGB565_VIDEO
+    // The translucency tables map palette indices, not pixels.
+    V_DrawPatch(x, y, patch);
+    return;
+#endif
+
     y -= SHORT(patch->topoffset);
     x -= SHORT(patch->leftoffset);
 
@@ -444,12 +539,14 @@ void V_DrawShadowedPatch(int x, int y, patch_t *patch)
         I_Error("Bad V_DrawShadowedPatch");
     }
 
+    V_MarkRect (x, y, SHORT(patch->width) + 2, SHORT(patch->height) + 2);
+
     col = 0;
-    desttop = dest_screen + y * SCREENWIDTH + x;
-    desttop2 = dest_screen + (y + 2) * SCREENWIDTH + x + 2;
+    desttop = dest_screen + SCREENOFFSET(x, y);
+    desttop2 = dest_screen + SCREENOFFSET(x + 2, y + 2);
 
     w = SHORT(patch->width);
-    for (; col < w; x++, col++, desttop++, desttop2++)
+    for (; col < w; x++, col++, desttop += SCREENPITCH_X, desttop2 += SCREENPITCH_X)
     {
         column = (column_t *) ((byte *) patch + LONG(patch->columnofs[col]));
 
@@ -458,16 +555,16 @@ void V_DrawShadowedPatch(int x, int y, patch_t *patch)
         while (column->topdelta != 0xff)
         {
             source = (byte *) column + 3;
-            dest = desttop + column->topdelta * SCREENWIDTH;
-            dest2 = desttop2 + column->topdelta * SCREENWIDTH;
+            dest = desttop + column->topdelta * SCREENPITCH_Y;
+            dest2 = desttop2 + column->topdelta * SCREENPITCH_Y;
             count = column->length;
 
             while (count--)
             {
                 *dest2 = tinttable[((*dest2) << 8)];
-                dest2 += SCREENWIDTH;
-                *dest = *source++;
-                dest += SCREENWIDTH;
+                dest2 += SCREENPITCH_Y;
+                *dest = I_PIXEL(*source++);
+                dest += SCREENPITCH_Y;
 
             }
             column = (column_t *) ((byte *) column + column->length + 4);
@@ -502,7 +599,10 @@ void V_LoadXlaTable(void)
 
 void V_DrawBlock(int x, int y, int width, int height, byte *src) 
 { 
-    byte *dest; 
+    pixel_t *dest; 
+#ifdef FEATURE_COLUMN_MAJOR_VIDEO
+    int x1, y1;
+#endif
  
 #ifdef RANGECHECK 
     if (x < 0
@@ -516,6 +616,19 @@ void V_DrawBlock(int x, int y, int width, int height, byte *src)
  
     V_MarkRect (x, y, width, height); 
  
+#ifdef FEATURE_COLUMN_MAJOR_VIDEO
+    // The block is stored row by row.
+    for (x1 = 0; x1 < width; x1++) 
+    { 
+	dest = dest_screen + SCREENOFFSET(x + x1, y); 
+
+	for (y1 = 0; y1 < height; y1++) 
+	{ 
+	    *dest = I_PIXEL(src[y1 * width + x1]); 
+	    dest += SCREENPITCH_Y; 
+	} 
+    } 
+#else
     dest = dest_screen + y * SCREENWIDTH + x; 
 
     while (height--) 
@@ -524,14 +637,17 @@ void V_DrawBlock(int x, int y, int width, int height, byte *src)
 	src += width; 
 	dest += SCREENWIDTH; 
     } 
+#endif
 } 
 
 void V_DrawFilledBox(int x, int y, int w, int h, int c)
 {
-    uint8_t *buf, *buf1;
+    pixel_t *buf, *buf1;
     int x1, y1;
 
-    buf = I_VideoBuffer + SCREENWIDTH * y + x;
+    V_MarkRect (x, y, w, h);
+
+    buf = I_VideoBuffer + SCREENOFFSET(x, y);
 
     for (y1 = 0; y1 < h; ++y1)
     {
@@ -539,37 +655,43 @@ void V_DrawFilledBox(int x, int y, int w, int h, int c)
 
         for (x1 = 0; x1 < w; ++x1)
         {
-            *buf1++ = c;
+            *buf1 = I_PIXEL(c);
+            buf1 += SCREENPITCH_X;
         }
 
-        buf += SCREENWIDTH;
+        buf += SCREENPITCH_Y;
     }
 }
 
 void V_DrawHorizLine(int x, int y, int w, int c)
 {
-    uint8_t *buf;
+    pixel_t *buf;
     int x1;
 
-    buf = I_VideoBuffer + SCREENWIDTH * y + x;
+    V_MarkRect (x, y, w, 1);
+
+    buf = I_VideoBuffer + SCREENOFFSET(x, y);
 
     for (x1 = 0; x1 < w; ++x1)
     {
-        *buf++ = c;
+        *buf = I_PIXEL(c);
+        buf += SCREENPITCH_X;
     }
 }
 
 void V_DrawVertLine(int x, int y, int h, int c)
 {
-    uint8_t *buf;
+    pixel_t *buf;
     int y1;
 
-    buf = I_VideoBuffer + SCREENWIDTH * y + x;
+    V_MarkRect (x, y, 1, h);
+
+    buf = I_VideoBuffer + SCREENOFFSET(x, y);
 
     for (y1 = 0; y1 < h; ++y1)
     {
-        *buf = c;
-        buf += SCREENWIDTH;
+        *buf = I_PIXEL(c);
+        buf += SCREENPITCH_Y;
     }
 }
 
@@ -588,7 +710,13 @@ void V_DrawBox(int x, int y, int w, int h, int c)
  
 void V_DrawRawScreen(byte *raw)
 {
+#ifdef FEATURE_COLUMN_MAJOR_VIDEO
+    // The lump is stored row by row.
+    V_DrawBlock(0, 0, SCREENWIDTH, SCREENHEIGHT, raw);
+#else
+    V_MarkRect (0, 0, SCREENWIDTH, SCREENHEIGHT);
     memcpy(dest_screen, raw, SCREENWIDTH * SCREENHEIGHT);
+#endif
 }
 
 //
@@ -603,7 +731,7 @@ void V_Init (void)
 
 // Set the buffer that the code draws to.
 
-void V_UseBuffer(byte *buffer)
+void V_UseBuffer(pixel_t *buffer)
 {
     dest_screen = buffer;
 }
@@ -823,6 +951,9 @@ void V_ScreenShot(char *format)
         I_Error ("V_ScreenShot: Couldn't create a PCX");
     }
 
+    // The screenshot writers take palette indices.
+#ifndef FEATURE_RGB565_VIDEO
+
 #ifdef HAVE_LIBPNG
     if (png_screenshots)
     {
@@ -838,6 +969,7 @@ void V_ScreenShot(char *format)
                  SCREENWIDTH, SCREENHEIGHT,
                  W_CacheLumpName (DEH_String("PLAYPAL"), PU_CACHE));
     }
+#endif
 }
 
 #define MOUSE_SPEED_BOX_WIDTH  120
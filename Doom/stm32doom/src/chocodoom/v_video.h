@@ -23,6 +23,7 @@
 #define __V_VIDEO__
 
 #include "doomtype.h"
+#include "i_video.h"
 
 // Needed because we are refering to patches.
 #include "v_patch.h"
@@ -36,6 +37,22 @@
 
 extern int dirtybox[4];
 
+// The screen is divided in tiles, to track which parts of it have
+// been drawn to since the last I_FinishUpdate: dirtytiles holds a
+// bit per tile row, for each tile column.
+
+#define DIRTYTILEWIDTH		16
+#define DIRTYTILEHEIGHT		8
+#define DIRTYTILECOLS		(SCREENWIDTH / DIRTYTILEWIDTH)
+#define DIRTYTILEROWS		(SCREENHEIGHT / DIRTYTILEHEIGHT)
+
+extern uint32_t dirtytiles[DIRTYTILECOLS];
+
+// Set when the whole screen changes, and is not worth comparing
+// with the previous frame (the 3D view is visible).
+
+extern boolean dirtyscreen;
+
 extern byte *tinttable;
 
 // haleyjd 08/28/10: implemented for Strife support
@@ -50,7 +67,7 @@ void V_Init (void);
 
 // Draw a block from the specified source screen to the screen.
 
-void V_CopyRect(int srcx, int srcy, byte *source,
+void V_CopyRect(int srcx, int srcy, pixel_t *source,
                 int width, int height,
                 int destx, int desty);
 
@@ -67,6 +84,7 @@ void V_DrawPatchDirect(int x, int y, patch_t *patch);
 void V_DrawBlock(int x, int y, int width, int height, byte *src);
 
 void V_MarkRect(int x, int y, int width, int height);
+void V_MarkScreen(void);
 
 void V_DrawFilledBox(int x, int y, int w, int h, int c);
 void V_DrawHorizLine(int x, int y, int w, int c);
@@ -79,7 +97,7 @@ void V_DrawRawScreen(byte *raw);
 
 // Temporarily switch to using a different buffer to draw graphics, etc.
 
-void V_UseBuffer(byte *buffer);
+void V_UseBuffer(pixel_t *buffer);
 
 // Return to using the normal screen buffer to draw graphics.
 
@@ -17,6 +17,8 @@
 //
 
 
+#include <string.h>
+
 #include "z_zone.h"
 #include "i_system.h"
 #include "doomtype.h"
@@ -64,6 +66,62 @@ typedef struct
 memzone_t*	mainzone;
 
 
+//
+// Zone usage accounting, kept up to date by Z_Malloc, Z_Free
+// and Z_ChangeTag so that Z_GetStats does not need to walk the zone.
+//
+static int	tag_inuse[PU_NUM_TAGS];
+static int	tag_peak[PU_NUM_TAGS];
+static int	tag_blocks[PU_NUM_TAGS];
+static int	tag_purges[PU_NUM_TAGS];
+static int	total_inuse;
+static int	total_peak;
+
+static const char *tag_names[PU_NUM_TAGS] =
+{
+    "",
+    "PU_STATIC",
+    "PU_SOUND",
+    "PU_MUSIC",
+    "PU_FREE",
+    "PU_LEVEL",
+    "PU_LEVSPEC",
+    "PU_PURGELEVEL",
+    "PU_CACHE",
+};
+
+static void Z_ClearStats (void)
+{
+    memset(tag_inuse, 0, sizeof(tag_inuse));
+    memset(tag_peak, 0, sizeof(tag_peak));
+    memset(tag_blocks, 0, sizeof(tag_blocks));
+    memset(tag_purges, 0, sizeof(tag_purges));
+    total_inuse = 0;
+    total_peak = 0;
+}
+
+static void Z_AccountBlock (int tag, int size)
+{
+    tag_inuse[tag] += size;
+    tag_blocks[tag]++;
+
+    if (tag_inuse[tag] > tag_peak[tag])
+        tag_peak[tag] = tag_inuse[tag];
+
+    total_inuse += size;
+
+    if (total_inuse > total_peak)
+        total_peak = total_inuse;
+}
+
+static void Z_UnaccountBlock (int tag, int size)
+{
+    tag_inuse[tag] -= size;
+    tag_blocks[tag]--;
+    total_inuse -= size;
+}
+
+
 
 //
 // Z_ClearZone
@@ -87,6 +145,8 @@ void Z_ClearZone (memzone_t* zone)
     block->tag = PU_FREE;
 
     block->size = zone->size - sizeof(memzone_t);
+
+    Z_ClearStats ();
 }
 
 
@@ -117,6 +177,8 @@ void Z_Init (void)
     block->tag = PU_FREE;
     
     block->size = mainzone->size - sizeof(memzone_t);
+
+    Z_ClearStats ();
 }
 
 
@@ -139,6 +201,9 @@ void Z_Free (void* ptr)
 	    *block->user = 0;
     }
 
+    if (block->tag != PU_FREE)
+        Z_UnaccountBlock (block->tag, block->size);
+
     // mark as free
     block->tag = PU_FREE;
     block->user = NULL;
@@ -235,6 +300,7 @@ Z_Malloc
                 // free the rover block (adding the size to base)
 
                 // the rover can be the base block
+                tag_purges[rover->tag]++;
                 base = base->prev;
                 Z_Free ((byte *)rover+sizeof(memblock_t));
                 base = base->next;
@@ -274,6 +340,8 @@ Z_Malloc
     base->user = user;
     base->tag = tag;
 
+    Z_AccountBlock (tag, base->size);
+
     result  = (void *) ((byte *)base + sizeof(memblock_t));
 
     if (base->user)
@@ -440,6 +508,9 @@ void Z_ChangeTag2(void *ptr, int tag, char *file, int line)
         I_Error("%s:%i: Z_ChangeTag: an owner is required "
                 "for purgable blocks", file, line);
 
+    Z_UnaccountBlock (block->tag, block->size);
+    Z_AccountBlock (tag, block->size);
+
     block->tag = tag;
 }
 
@@ -486,3 +557,67 @@ unsigned int Z_ZoneSize(void)
     return mainzone->size;
 }
 
+
+
+//
+// Z_GetStats
+// Fills in the current zone usage. Only the free block
+// figures need a walk of the zone.
+//
+void Z_GetStats (zonestats_t *stats)
+{
+    memblock_t*		block;
+
+    memset(stats, 0, sizeof(*stats));
+
+    stats->zonesize = mainzone->size;
+
+    memcpy(stats->inuse, tag_inuse, sizeof(stats->inuse));
+    memcpy(stats->peak, tag_peak, sizeof(stats->peak));
+    memcpy(stats->blocks, tag_blocks, sizeof(stats->blocks));
+    memcpy(stats->purges, tag_purges, sizeof(stats->purges));
+
+    stats->totalinuse = total_inuse;
+    stats->totalpeak = total_peak;
+
+    for (block = mainzone->blocklist.next ;
+         block != &mainzone->blocklist;
+         block = block->next)
+    {
+        if (block->tag != PU_FREE)
+            continue;
+
+        stats->freeblocks++;
+
+        if (block->size > stats->largestfree)
+            stats->largestfree = block->size;
+    }
+}
+
+
+//
+// Z_DumpStats
+//
+void Z_DumpStats (void)
+{
+    zonestats_t		stats;
+    int			i;
+
+    Z_GetStats (&stats);
+
+    printf ("zone size: %i  in use: %i  peak: %i\n",
+            stats.zonesize, stats.totalinuse, stats.totalpeak);
+
+    printf ("free blocks: %i  largest free: %i\n",
+            stats.freeblocks, stats.largestfree);
+
+    for (i = PU_STATIC; i < PU_NUM_TAGS; i++)
+    {
+        if (i == PU_FREE)
+            continue;
+
+        printf ("%-14s  in use:%8i  peak:%8i  blocks:%6i  purges:%6i\n",
+                tag_names[i], stats.inuse[i], stats.peak[i],
+                stats.blocks[i], stats.purges[i]);
+    }
+}
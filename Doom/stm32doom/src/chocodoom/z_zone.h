@@ -48,6 +48,24 @@ enum
 
     PU_NUM_TAGS
 };
+
+//
+// Zone usage statistics, see Z_GetStats.
+// All sizes are in bytes and include the block headers.
+//
+
+typedef struct
+{
+    int zonesize;                   // total size of the zone
+    int inuse[PU_NUM_TAGS];         // bytes currently held, per tag
+    int peak[PU_NUM_TAGS];          // high-water mark of inuse, per tag
+    int blocks[PU_NUM_TAGS];        // number of blocks held, per tag
+    int purges[PU_NUM_TAGS];        // blocks purged by Z_Malloc, per tag
+    int totalinuse;                 // bytes held by all tags
+    int totalpeak;                  // high-water mark of totalinuse
+    int freeblocks;                 // number of free blocks
+    int largestfree;                // size of the largest free block
+} zonestats_t;
         
 
 void	Z_Init (void);
@@ -61,6 +79,8 @@ void    Z_ChangeTag2 (void *ptr, int tag, char *file, int line);
 void    Z_ChangeUser(void *ptr, void **user);
 int     Z_FreeMemory (void);
 unsigned int Z_ZoneSize(void);
+void    Z_GetStats (zonestats_t *stats);
+void    Z_DumpStats (void);
 
 //
 // This is used to get the local FILE:LINE info from CPP
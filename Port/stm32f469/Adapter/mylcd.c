@@ -22,6 +22,7 @@
 #include <string.h>
 #include "RoboticTypes.h"
 #include "IDraw.h"
+#include "IInterrupt.h"
 #include "IWatchdog.h"
 #include "LCD.h"
 #include "mylcd.h"
@@ -34,15 +35,252 @@
 #define ROWS ( 240 ) // physical LCD screen height (screen is rotated 270 degrees in relation to user)
 #define COLS ( 320 ) // physical LCD screen width (screen is rotated 270 degrees in relation to user)
 
+#define LCD_FRAME_BUFFERS     ( 2 )                                // ping-pong buffers, one drawn while the other is transferred
+#define LCD_FRAME_BUFFER_SIZE ( LCD_MAX_X * LCD_MAX_Y * 2 )       // RGB565 pixels
+#define LCD_BAND_SIZE         ( LCD_MAX_X * LCD_BAND_ROWS * 2 )    // RGB565 pixels
+#define LCD_INDEXED_BUFFER    ( LCD_FRAME_BUFFERS )                // the 8-bit frame of lcd_refresh_indexed(), as a transfer buffer
+#define LCD_INDEXED_BAND_SIZE ( LCD_MAX_X * LCD_BAND_ROWS )        // CLUT indices
+#define LCD_BUFFERS           ( LCD_FRAME_BUFFERS + 1 )            // transfer buffers, the frame buffers and the 8-bit frame
+#define LCD_QUEUE_SIZE        ( LCD_BUFFERS * LCD_REFRESH_BANDS )  // each band of each buffer is queued at most once
+
+#if ( 0 != ( LCD_MAX_Y % LCD_REFRESH_BANDS ) ) || ( 32 < LCD_REFRESH_BANDS )
+#error "LCD_REFRESH_BANDS must divide LCD_MAX_Y, and be at most 32"
+#endif
+
+/*
+ ------------------------------------------------------------------------------
+    Types
+ ------------------------------------------------------------------------------
+ */
+// a band of a frame buffer to transfer to the LCD
+typedef struct
+{
+    uint8_t buffer;
+    uint8_t band;
+    bool    frameEnd; // the last band of a frame
+} tLcdTransfer;
+
 /*
  ------------------------------------------------------------------------------
     Private data
  ------------------------------------------------------------------------------
  */
 /*
- * we have a simple buffer that we let the DOOM code write into, before we transfer the data to the LCD driver
+ * we have a buffer that we let the DOOM code write into, before we transfer the data to the LCD driver
+ * the buffer is converted and transferred in bands, so the DMA2D transfers a band while the next band is converted
+ * with double buffering, a second buffer is drawn into while the previous frame is transferred
+ */
+static uint8_t* lcd_frame_buffers[ LCD_FRAME_BUFFERS ] = { NULL };
+static uint8_t  lcd_back_buffer                       = 0;
+static bool     lcd_double_buffered                   = ( 1 == LCD_REFRESH_BANDS );
+static bool     lcd_frame_queued                      = false; // a band of the screen buffer was queued since lcd_refresh_end()
+
+// alternatively, an 8-bit frame is converted by the DMA2D through the CLUT while transferred;
+// the DMA2D only loads a CLUT at another address, so a new CLUT goes into the other one
+static const uint8_t* lcd_indexed_frame = NULL;
+static uint32_t       lcd_cluts[ 2 ][ 256 ];
+static uint8_t        lcd_clut = 0;
+
+// fences, a bit per band of each buffer, set while the band is queued or transferred, cleared from the DMA2D interrupt
+static volatile uint32_t lcd_busy_bands[ LCD_BUFFERS ] = { 0 };
+
+// transfer queue, filled by lcd_refresh_band() and emptied from the DMA2D interrupt;
+// the transfers of complete frames are released at the next vertical blankings, a frame at each
+static tLcdTransfer     lcd_queue[ LCD_QUEUE_SIZE ];
+static volatile uint8_t lcd_queue_head      = 0; // next transfer to start
+static volatile uint8_t lcd_queue_count     = 0;
+static volatile uint8_t lcd_queue_ended     = 0; // the first queued transfers that belong to complete frames
+static volatile uint8_t lcd_queue_released  = 0; // the first of those that may start
+static volatile bool    lcd_transfer_active = false;
+static tLcdTransfer     lcd_transfer;            // the active transfer
+
+// frames are paced to the vertical blanking as soon as it is seen to happen
+static volatile bool    lcd_paced = false;
+static tLcdPresentStats lcd_stats;
+static uint32_t         lcd_last_frame_vblank = 0;
+
+/*
+ ------------------------------------------------------------------------------
+    Private functions
+ ------------------------------------------------------------------------------
+ */
+static void lcd_transfer_done( tEvent event );
+
+/**
+ ******************************************************************************
+ * @brief   Starts the DMA2D transfer of a band to the LCD
+ * @return  true if the transfer was started
+ ******************************************************************************
+ */
+static bool lcd_start_transfer( const tLcdTransfer transfer )
+{
+    // a band is a number of rows of the (rotated) frame buffer, i.e. DOOM screen columns
+    tIDraw_ControlBlock cb;
+    cb.header.xSize     = LCD_BAND_ROWS;
+    cb.header.ySize     = LCD_MAX_X;
+    if ( LCD_INDEXED_BUFFER == transfer.buffer )
+    {
+        cb.header.totalSize = LCD_INDEXED_BAND_SIZE;
+        cb.header.format    = IDRAW_FORMAT_L8;
+
+        cb.dataL8.pData = (uint8*)( lcd_indexed_frame + transfer.band * LCD_INDEXED_BAND_SIZE );
+        cb.dataL8.pClut = lcd_cluts[ lcd_clut ];
+        cb.dataL8.pitch = LCD_BAND_ROWS;
+    }
+    else
+    {
+        cb.header.totalSize = LCD_BAND_SIZE;
+        cb.header.format    = IDRAW_FORMAT_RGB565;
+
+        cb.dataRGB565.pData = (uint16*)( lcd_frame_buffers[ transfer.buffer ] + transfer.band * LCD_BAND_SIZE );
+        cb.dataRGB565.pitch = LCD_BAND_ROWS;
+    }
+
+    // as the DOOM screen has less rows than the actual physical screen, we center it on the screen (y-offset)
+    // due to the rotation, the last band is drawn at x = 0
+    return IDraw_Draw( &cb, LCD_MAX_Y - ( transfer.band + 1 ) * LCD_BAND_ROWS, 20, &lcd_transfer_done );
+}
+
+/**
+ ******************************************************************************
+ * @brief   Starts the next queued transfer, if the DMA2D is idle
+ *          Called with interrupts disabled, or from the DMA2D interrupt
+ ******************************************************************************
+ */
+static void lcd_start_next( void )
+{
+    while ( !lcd_transfer_active && ( 0 < lcd_queue_released ) )
+    {
+        const tLcdTransfer transfer = lcd_queue[ lcd_queue_head ];
+        lcd_queue_head              = ( lcd_queue_head + 1 ) % LCD_QUEUE_SIZE;
+        lcd_queue_count--;
+        lcd_queue_ended--;
+        lcd_queue_released--;
+
+        lcd_transfer        = transfer;
+        lcd_transfer_active = true;
+        if ( !lcd_start_transfer( transfer ) )
+        {
+            lcd_transfer_active = false;
+            lcd_busy_bands[ transfer.buffer ] &= ~( 1u << transfer.band );
+        }
+    }
+}
+
+/**
+ ******************************************************************************
+ * @brief   Called from the DMA2D interrupt when a band transfer is done (or failed)
+ ******************************************************************************
+ */
+static void lcd_transfer_done( tEvent event )
+{
+    (void)event;
+    lcd_busy_bands[ lcd_transfer.buffer ] &= ~( 1u << lcd_transfer.band );
+    lcd_transfer_active = false;
+    lcd_start_next();
+}
+
+/**
+ ******************************************************************************
+ * @brief   Called from the LTDC interrupt at the start of each vertical blanking
+ *          Releases the transfers of the next complete frame, the DMA2D then
+ *          stays ahead of the LCD scanning the frame buffer from the top; a
+ *          later frame waits for the next vertical blanking, transferred right
+ *          behind this one it would be torn by the scan
+ ******************************************************************************
+ */
+static void lcd_vertical_blank( tEvent event )
+{
+    (void)event;
+    lcd_paced = true;
+    lcd_stats.vblanks++;
+
+    if ( lcd_transfer_active || ( 0 < lcd_queue_released ) )
+    {
+        lcd_stats.missed++;
+    }
+
+    if ( lcd_queue_ended > lcd_queue_released )
+    {
+        if ( ( 0 < lcd_stats.frames ) && ( lcd_stats.maxInterval < lcd_stats.vblanks - lcd_last_frame_vblank ) )
+        {
+            lcd_stats.maxInterval = lcd_stats.vblanks - lcd_last_frame_vblank;
+        }
+        lcd_last_frame_vblank = lcd_stats.vblanks;
+        lcd_stats.frames++;
+
+        do
+        {
+            lcd_queue_released++;
+        } while ( ( lcd_queue_released < lcd_queue_ended ) &&
+                  !lcd_queue[ ( lcd_queue_head + lcd_queue_released - 1 ) % LCD_QUEUE_SIZE ].frameEnd );
+        lcd_start_next();
+    }
+}
+
+/**
+ ******************************************************************************
+ * @brief   Marks the transfers queued so far as a complete frame, started at
+ *          the next vertical blanking after the frames before it (or straight
+ *          away, until that is seen)
+ ******************************************************************************
  */
-static uint8_t* lcd_frame_buffer = NULL;
+static void lcd_end_frame( void )
+{
+    IInterrupt_GlobalDisable();
+    if ( lcd_queue_ended < lcd_queue_count )
+    {
+        lcd_queue[ ( lcd_queue_head + lcd_queue_count - 1 ) % LCD_QUEUE_SIZE ].frameEnd = true;
+    }
+    lcd_queue_ended = lcd_queue_count;
+    if ( !lcd_paced )
+    {
+        lcd_queue_released = lcd_queue_ended;
+        lcd_start_next();
+    }
+    IInterrupt_GlobalEnable();
+}
+
+/**
+ ******************************************************************************
+ * @brief   Queues a band of a buffer for transfer to the LCD, once the band is
+ *          no longer queued or transferred
+ ******************************************************************************
+ */
+static void lcd_queue_band( const uint8_t buffer, const int band )
+{
+    static bool once = false;
+
+    if ( !once )
+    {
+        once = true;
+
+        ILCD_SetRotation( LCD_ROTATION_REVERSE );
+
+        // make the entire screen black, queued ahead of the band
+        IDraw_Fill( 0xFF000000, NULL );
+    }
+    // a band is queued at most once
+    while ( 0 != ( lcd_busy_bands[ buffer ] & ( 1u << band ) ) )
+    {
+        // wait for the DMA2D interrupt
+    }
+
+    // queue the band, it is started once it is released and the previous transfer is done
+    IInterrupt_GlobalDisable();
+    lcd_busy_bands[ buffer ] |= 1u << band;
+    lcd_queue[ ( lcd_queue_head + lcd_queue_count ) % LCD_QUEUE_SIZE ] = ( tLcdTransfer ){ .buffer = buffer, .band = (uint8_t)band };
+    lcd_queue_count++;
+
+    // until frames are paced, a band starts as soon as it is queued, while the next one is converted
+    if ( !lcd_paced )
+    {
+        lcd_queue_ended    = lcd_queue_count;
+        lcd_queue_released = lcd_queue_ended;
+        lcd_start_next();
+    }
+    IInterrupt_GlobalEnable();
+}
 
 /*
  ------------------------------------------------------------------------------
@@ -56,8 +294,13 @@ static uint8_t* lcd_frame_buffer = NULL;
  */
 void lcd_init( void )
 {
-    lcd_frame_buffer = malloc( 320 * 200 * 2 );
-    memset( lcd_frame_buffer, '\0', 320 * 200 * 2 );
+    const int buffers = lcd_double_buffered ? LCD_FRAME_BUFFERS : 1;
+    for ( int i = 0; i < buffers; ++i )
+    {
+        lcd_frame_buffers[ i ] = malloc( LCD_FRAME_BUFFER_SIZE );
+        memset( lcd_frame_buffers[ i ], '\0', LCD_FRAME_BUFFER_SIZE );
+    }
+    ILCD_SetVerticalBlankCallback( &lcd_vertical_blank );
 }
 
 /**
@@ -77,26 +320,128 @@ void lcd_start( void )
  */
 void lcd_refresh( void )
 {
-    static bool once = false;
+    for ( int band = 0; band < LCD_REFRESH_BANDS; ++band )
+    {
+        lcd_refresh_band( band );
+    }
+    lcd_refresh_end();
+}
 
-    if ( !once )
+/**
+ ******************************************************************************
+ * Function
+ ******************************************************************************
+ */
+void lcd_refresh_band( const int band )
+{
+    lcd_queue_band( lcd_back_buffer, band );
+    lcd_frame_queued = true;
+}
+
+/**
+ ******************************************************************************
+ * Function
+ ******************************************************************************
+ */
+void lcd_refresh_end( void )
+{
+    lcd_end_frame();
+
+    // the next frame goes into the other buffer, unless nothing of this one was transferred
+    if ( lcd_double_buffered && lcd_frame_queued )
     {
-        once = true;
+        lcd_back_buffer = ( lcd_back_buffer + 1 ) % LCD_FRAME_BUFFERS;
+    }
+    lcd_frame_queued = false;
 
-        ILCD_SetRotation( LCD_ROTATION_REVERSE );
+    // each time we are asked to refresh the screen, the DOOM game seems to be working
+    IWatchdog_Refresh();
+}
 
-        // make the entire screen black
-        IDraw_FillDisplay( 0xFF000000 );
+/**
+ ******************************************************************************
+ * Function
+ ******************************************************************************
+ */
+void lcd_set_clut( const uint32_t* pClut )
+{
+    lcd_sync();
+    lcd_clut = ( lcd_clut + 1 ) % 2;
+    memcpy( lcd_cluts[ lcd_clut ], pClut, sizeof( lcd_cluts[ lcd_clut ] ) );
+}
+
+/**
+ ******************************************************************************
+ * Function
+ ******************************************************************************
+ */
+void lcd_refresh_indexed( const uint8_t* pFrame )
+{
+    // the frame is only replaced once all bands of the previous one are transferred
+    while ( 0 != lcd_busy_bands[ LCD_INDEXED_BUFFER ] )
+    {
+        // wait for the DMA2D interrupt
     }
-    // simply draw the entire screen buffer on the LCD display
-    // as the DOOM screen has less rows than the actual physical screen, we center it on the screen (y-offset)
-    const tIDraw_Position pos = { .x = 0, .y = 20 };
-    IDraw_ImageFromMemory( (const void* const)lcd_frame_buffer, (tIDraw_Position*)&pos );
+    lcd_indexed_frame = pFrame;
+    for ( int band = 0; band < LCD_REFRESH_BANDS; ++band )
+    {
+        lcd_queue_band( LCD_INDEXED_BUFFER, band );
+    }
+    lcd_end_frame();
 
     // each time we are asked to refresh the screen, the DOOM game seems to be working
     IWatchdog_Refresh();
 }
 
+/**
+ ******************************************************************************
+ * Function
+ ******************************************************************************
+ */
+void lcd_sync( void )
+{
+    for ( int i = 0; i < LCD_BUFFERS; ++i )
+    {
+        while ( 0 != lcd_busy_bands[ i ] )
+        {
+            // wait for the DMA2D interrupt
+        }
+    }
+}
+
+/**
+ ******************************************************************************
+ * Function
+ ******************************************************************************
+ */
+void lcd_sync_band( const int band )
+{
+    while ( 0 != ( lcd_busy_bands[ lcd_back_buffer ] & ( 1u << band ) ) )
+    {
+        // wait for the DMA2D interrupt
+    }
+}
+
+/**
+ ******************************************************************************
+ * Function
+ ******************************************************************************
+ */
+void lcd_set_double_buffered( const bool enable )
+{
+    lcd_sync();
+    if ( enable && ( NULL == lcd_frame_buffers[ 1 ] ) )
+    {
+        lcd_frame_buffers[ 1 ] = malloc( LCD_FRAME_BUFFER_SIZE );
+        if ( NULL == lcd_frame_buffers[ 1 ] )
+        {
+            return;
+        }
+        memset( lcd_frame_buffers[ 1 ], '\0', LCD_FRAME_BUFFER_SIZE );
+    }
+    lcd_double_buffered = enable;
+}
+
 /**
  ******************************************************************************
  * Function
@@ -104,5 +449,17 @@ void lcd_refresh( void )
  */
 uint8_t* lcd_get_frame_buffer( void )
 {
-    return (uint8_t*)lcd_frame_buffer;
+    return lcd_frame_buffers[ lcd_back_buffer ];
+}
+
+/**
+ ******************************************************************************
+ * Function
+ ******************************************************************************
+ */
+void lcd_get_present_stats( tLcdPresentStats* pStats )
+{
+    IInterrupt_GlobalDisable();
+    *pStats = lcd_stats;
+    IInterrupt_GlobalEnable();
 }
@@ -13,6 +13,9 @@
 #ifndef __MY_LCD_H__
 #define __MY_LCD_H__
 
+#include <stdbool.h>
+#include <stdint.h>
+
 /*
  ------------------------------------------------------------------------------
     Defines
@@ -21,11 +24,32 @@
 #define LCD_MAX_X ( 200 ) // DOOM LCD screen max width (screen is rotated 270 degrees in relation to user)
 #define LCD_MAX_Y ( 320 ) // DOOM LCD screen max height (screen is rotated 270 degrees in relation to user)
 
+// number of bands the screen is transferred in, 1 for whole frames; may be set in DEFINES,
+// the dirty tiles of i_video.c take 1, 2, 4, 5, 10 or 20
+#ifndef LCD_REFRESH_BANDS
+#define LCD_REFRESH_BANDS ( 4 )
+#endif
+#define LCD_BAND_ROWS     ( LCD_MAX_Y / LCD_REFRESH_BANDS ) // LCD rows (DOOM screen columns) per band
+
 #define LCD_RGB565( r, g, b )   ( ( ( ( r & 0xF8 ) >> 3 ) << 11 ) | ( ( ( g & 0xFC ) >> 2 ) << 5 ) | ( ( b & 0xF8 ) >> 3 ) )
 #define LCD_RGB565_R( color )   ( ( 0xF800 & color ) >> 11 )
 #define LCD_RGB565_G( color )   ( ( 0x07E0 & color ) >> 5 )
 #define LCD_RGB565_B( color )   ( 0x001F & color )
 
+/*
+ ------------------------------------------------------------------------------
+    Types
+ ------------------------------------------------------------------------------
+ */
+// frame pacing statistics, see lcd_get_present_stats()
+typedef struct
+{
+    uint32_t vblanks;     // vertical blanking intervals
+    uint32_t frames;      // vertical blankings that started the transfer of a new frame
+    uint32_t missed;      // vertical blankings that found the previous frame still being transferred
+    uint32_t maxInterval; // most vertical blankings from one new frame to the next
+} tLcdPresentStats;
+
 /*
  ------------------------------------------------------------------------------
     Interface functions
@@ -48,16 +72,96 @@ extern void lcd_start( void );
 /**
  ******************************************************************************
  * @brief   Called whenever the screen buffer has been updated
+ *          Queues all bands of the screen buffer for transfer to the LCD
+ *          Transfers of a frame start at the next vertical blanking, a frame
+ *          at each, so that they stay ahead of the LCD scanning the frame buffer
  ******************************************************************************
  */
 extern void lcd_refresh( void );
 
+/**
+ ******************************************************************************
+ * @brief   Called whenever a band of the screen buffer has been updated
+ *          Queues the band for transfer to the LCD, and returns straight away
+ *          Until the first vertical blanking is seen, the transfer starts
+ *          straight away too, otherwise with its frame
+ *          Bands that have not changed need not be refreshed, and a band is
+ *          refreshed at most once until lcd_refresh_end()
+ * @param   band    the band, 0 to LCD_REFRESH_BANDS-1 (LCD rows band * LCD_BAND_ROWS and on)
+ ******************************************************************************
+ */
+extern void lcd_refresh_band( const int band );
+
+/**
+ ******************************************************************************
+ * @brief   Called when all changed bands of the screen buffer have been refreshed
+ *          When double buffered and any band was refreshed, makes the other
+ *          buffer the screen buffer
+ ******************************************************************************
+ */
+extern void lcd_refresh_end( void );
+
+/**
+ ******************************************************************************
+ * @brief   Sets the CLUT that lcd_refresh_indexed() converts through
+ *          Waits until all queued transfers are done first
+ * @param   pClut   256 colors, ARGB8888
+ ******************************************************************************
+ */
+extern void lcd_set_clut( const uint32_t* pClut );
+
+/**
+ ******************************************************************************
+ * @brief   Queues all bands of an 8-bit frame, in the layout of the screen buffer
+ *          but with a CLUT index per pixel, for transfer to the LCD
+ *          The DMA2D converts the pixels through the CLUT on the way, so the frame
+ *          must not change until the transfers are done (see lcd_sync())
+ * @param   pFrame  the frame, LCD_MAX_X * LCD_MAX_Y CLUT indices
+ ******************************************************************************
+ */
+extern void lcd_refresh_indexed( const uint8_t* pFrame );
+
+/**
+ ******************************************************************************
+ * @brief   Waits until all queued transfers are done
+ ******************************************************************************
+ */
+extern void lcd_sync( void );
+
+/**
+ ******************************************************************************
+ * @brief   Waits until a band of the screen buffer is no longer being transferred
+ *          Call this before drawing into the band again
+ * @param   band    the band, 0 to LCD_REFRESH_BANDS-1
+ ******************************************************************************
+ */
+extern void lcd_sync_band( const int band );
+
+/**
+ ******************************************************************************
+ * @brief   Selects double buffering or a single screen buffer
+ *          Double buffering is the default when the screen is not transferred in
+ *          bands. Use a single buffer when the screen is updated incrementally
+ * @param   enable  true for double buffering
+ ******************************************************************************
+ */
+extern void lcd_set_double_buffered( const bool enable );
+
 /**
  ******************************************************************************
  * @brief   Gets hold of the adapter's allocated LCD screen buffer
  *          Simply write to this and call lcd_refresh() to draw a new screen
+ *          When double buffered, get hold of it again after each lcd_refresh()
  ******************************************************************************
  */
 extern uint8_t* lcd_get_frame_buffer( void );
 
+/**
+ ******************************************************************************
+ * @brief   Gets the frame pacing statistics, counted since start-up
+ * @param   pStats  receives the statistics
+ ******************************************************************************
+ */
+extern void lcd_get_present_stats( tLcdPresentStats* pStats );
+
 #endif // __MY_LCD_H__
@@ -0,0 +1,339 @@
+/**
+ ******************************************************************************
+ * Copyright (c) 2023 Husqvarna AB.
+ * All rights reserved.
+ *
+ * This software is licensed under terms that can be found in the LICENSE file
+ * in the root directory of this software component.
+ * If no LICENSE file comes with this software, it is provided AS-IS.
+ *
+ ******************************************************************************
+ */
+
+/*
+ ------------------------------------------------------------------------------
+    Include files
+ ------------------------------------------------------------------------------
+ */
+
+#include <string.h>
+#include <RoboticTypes.h>
+#include "mysave.h"
+
+/*
+ ------------------------------------------------------------------------------
+    Defines
+ ------------------------------------------------------------------------------
+ */
+/*
+ * The savegames are kept in the SDRAM between the end of the heap (_esdram) and the WAD file:
+ *
+ * ---------------------------:---------------------------------------------:-------------
+ * newlib heap                : slot 0 | slot 1 | ... | slot 5 | scratch    : IWAD
+ * ---------------------------:---------------------------------------------:-------------
+ *                 _esdram  --^-- SAVE_START_ADDRESS        WAD_START_ADDRESS --^
+ *
+ * A new savegame is compressed into the scratch slot first, and only copied to its slot
+ * once it is known to fit, so that a failed save never destroys the previous one.
+ */
+#define SAVE_START_ADDRESS ( (uint8*)0xC0A00000 )
+#define SAVE_SLOT_SIZE     ( 0x20000 )      // bytes per slot, including the header
+#define SAVE_SCRATCH_SLOT  ( SAVE_SLOTS )   // the slot following the last savegame slot
+#define SAVE_MAGIC         ( 0x53564731 )   // "SVG1"
+
+#define SAVE_SLOT( slot )  ( (tSaveSlot*)( SAVE_START_ADDRESS + ( slot ) * SAVE_SLOT_SIZE ) )
+#define SAVE_DATA_SIZE     ( SAVE_SLOT_SIZE - sizeof( tSaveSlot ) )
+
+/*
+ * Compressed format, a sequence of:
+ * - literal run: control byte 0x00-0x7F, followed by (control + 1) bytes
+ * - match:       control byte 0x80-0xFF, followed by a 16-bit little endian (distance - 1),
+ *                copies ((control & 0x7F) + LZ_MIN_MATCH) bytes from distance bytes back
+ *                (the copy may overlap itself, which turns runs of a value into short matches)
+ */
+#define LZ_MIN_MATCH    ( 3 )
+#define LZ_MAX_MATCH    ( 0x7F + LZ_MIN_MATCH )
+#define LZ_MAX_LITERALS ( 0x80 )
+#define LZ_MAX_DISTANCE ( 0x10000 )
+#define LZ_HASH_BITS    ( 12 )
+#define LZ_HASH( p )    ( ( ( ( p )[ 0 ] << 8 ) ^ ( ( p )[ 1 ] << 4 ) ^ ( p )[ 2 ] ) & ( ( 1 << LZ_HASH_BITS ) - 1 ) )
+
+/*
+ ------------------------------------------------------------------------------
+    Types
+ ------------------------------------------------------------------------------
+ */
+// the header in front of every stored savegame
+typedef struct
+{
+    uint32 magic;      // SAVE_MAGIC if the slot holds a savegame
+    uint32 size;       // uncompressed size of the savegame
+    uint32 packedSize; // compressed size of the savegame
+    uint32 checksum;   // simple sum of the compressed data
+    uint8  data[];     // the compressed savegame
+} tSaveSlot;
+
+/*
+ ------------------------------------------------------------------------------
+    Private data
+ ------------------------------------------------------------------------------
+ */
+// last position (+1) of each 3-byte sequence hash, 0 if not seen yet
+static uint32 lzHashTable[ 1 << LZ_HASH_BITS ];
+
+/*
+ ------------------------------------------------------------------------------
+    Private functions
+ ------------------------------------------------------------------------------
+ */
+/**
+ ******************************************************************************
+ * @brief   Sums the bytes of a memory area, to detect stale or garbage slot data
+ ******************************************************************************
+ */
+static uint32 save_checksum( const uint8* pData, size_t size )
+{
+    uint32 sum = 0;
+    while ( 0 < size-- )
+    {
+        sum += *pData++;
+    }
+    return sum;
+}
+
+/**
+ ******************************************************************************
+ * @brief   Writes a literal run to the compressed output
+ * @return  the new output position, 0 if the output is full
+ ******************************************************************************
+ */
+static size_t save_put_literals( const uint8* pSrc, size_t count, uint8* pDst, size_t pos, const size_t capacity )
+{
+    while ( 0 < count )
+    {
+        const size_t run = ( LZ_MAX_LITERALS < count ) ? LZ_MAX_LITERALS : count;
+        if ( capacity < pos + 1 + run )
+        {
+            return 0;
+        }
+        pDst[ pos++ ] = (uint8)( run - 1 );
+        memcpy( &pDst[ pos ], pSrc, run );
+        pos   += run;
+        pSrc  += run;
+        count -= run;
+    }
+    return pos;
+}
+
+/**
+ ******************************************************************************
+ * @brief   Compresses a buffer
+ * @return  the compressed size, 0 if it does not fit in the output
+ ******************************************************************************
+ */
+static size_t save_compress( const uint8* const pSrc, const size_t size, uint8* const pDst, const size_t capacity )
+{
+    size_t pos        = 0;
+    size_t literalPos = 0;
+    size_t outPos     = 0;
+
+    memset( lzHashTable, 0, sizeof( lzHashTable ) );
+
+    while ( pos + LZ_MIN_MATCH <= size )
+    {
+        const uint32 hash      = LZ_HASH( &pSrc[ pos ] );
+        const size_t candidate = lzHashTable[ hash ];
+        lzHashTable[ hash ]    = pos + 1;
+
+        if ( ( 0 != candidate ) && ( LZ_MAX_DISTANCE >= pos - ( candidate - 1 ) )
+             && ( 0 == memcmp( &pSrc[ candidate - 1 ], &pSrc[ pos ], LZ_MIN_MATCH ) ) )
+        {
+            const size_t distance = pos - ( candidate - 1 );
+            size_t       length   = LZ_MIN_MATCH;
+
+            while ( ( LZ_MAX_MATCH > length ) && ( size > pos + length )
+                    && ( pSrc[ pos + length - distance ] == pSrc[ pos + length ] ) )
+            {
+                ++length;
+            }
+
+            if ( pos > literalPos )
+            {
+                outPos = save_put_literals( &pSrc[ literalPos ], pos - literalPos, pDst, outPos, capacity );
+                if ( 0 == outPos )
+                {
+                    return 0;
+                }
+            }
+            if ( capacity < outPos + 3 )
+            {
+                return 0;
+            }
+            pDst[ outPos++ ] = (uint8)( 0x80 | ( length - LZ_MIN_MATCH ) );
+            pDst[ outPos++ ] = (uint8)( ( distance - 1 ) & 0xFF );
+            pDst[ outPos++ ] = (uint8)( ( distance - 1 ) >> 8 );
+
+            pos += length;
+            literalPos = pos;
+        }
+        else
+        {
+            ++pos;
+        }
+    }
+
+    if ( size > literalPos )
+    {
+        outPos = save_put_literals( &pSrc[ literalPos ], size - literalPos, pDst, outPos, capacity );
+    }
+    return outPos;
+}
+
+/**
+ ******************************************************************************
+ * @brief   Decompresses (the start of) a buffer
+ * @return  the number of bytes decompressed, at most size
+ ******************************************************************************
+ */
+static size_t save_decompress( const uint8* pSrc, const size_t packedSize, uint8* const pDst, const size_t size )
+{
+    const uint8* const pSrcEnd = pSrc + packedSize;
+    size_t             outPos  = 0;
+
+    while ( ( pSrcEnd > pSrc ) && ( size > outPos ) )
+    {
+        const uint8 control = *pSrc++;
+
+        if ( 0 == ( control & 0x80 ) )
+        {
+            size_t run = control + 1;
+            if ( (size_t)( pSrcEnd - pSrc ) < run )
+            {
+                break;
+            }
+            if ( size - outPos < run )
+            {
+                run = size - outPos;
+            }
+            memcpy( &pDst[ outPos ], pSrc, run );
+            pSrc   += control + 1;
+            outPos += run;
+        }
+        else
+        {
+            if ( 2 > pSrcEnd - pSrc )
+            {
+                break;
+            }
+            const size_t distance = ( pSrc[ 0 ] | ( pSrc[ 1 ] << 8 ) ) + 1;
+            size_t       length   = ( control & 0x7F ) + LZ_MIN_MATCH;
+            pSrc += 2;
+
+            if ( distance > outPos )
+            {
+                break;
+            }
+            if ( size - outPos < length )
+            {
+                length = size - outPos;
+            }
+            // byte by byte, as the copy may overlap itself
+            while ( 0 < length-- )
+            {
+                pDst[ outPos ] = pDst[ outPos - distance ];
+                ++outPos;
+            }
+        }
+    }
+    return outPos;
+}
+
+/**
+ ******************************************************************************
+ * @brief   Gets hold of a slot if it holds a valid savegame
+ * @return  the slot, NULL if it is out of range or holds no valid savegame
+ ******************************************************************************
+ */
+static const tSaveSlot* save_valid_slot( const int slot )
+{
+    if ( ( 0 > slot ) || ( SAVE_SLOTS <= slot ) )
+    {
+        return NULL;
+    }
+    const tSaveSlot* const pSlot = SAVE_SLOT( slot );
+    if ( ( SAVE_MAGIC != pSlot->magic ) || ( SAVE_DATA_SIZE < pSlot->packedSize ) )
+    {
+        return NULL;
+    }
+    if ( pSlot->checksum != save_checksum( pSlot->data, pSlot->packedSize ) )
+    {
+        return NULL;
+    }
+    return pSlot;
+}
+
+/*
+ ------------------------------------------------------------------------------
+    Interface functions
+ ------------------------------------------------------------------------------
+ */
+/**
+ ******************************************************************************
+ * Function
+ ******************************************************************************
+ */
+size_t save_slot_size( const int slot )
+{
+    const tSaveSlot* const pSlot = save_valid_slot( slot );
+    if ( NULL == pSlot )
+    {
+        return 0;
+    }
+    return pSlot->size;
+}
+
+/**
+ ******************************************************************************
+ * Function
+ ******************************************************************************
+ */
+size_t save_slot_read( const int slot, void* const buff, const size_t size )
+{
+    const tSaveSlot* const pSlot = save_valid_slot( slot );
+    if ( ( NULL == pSlot ) || ( NULL == buff ) )
+    {
+        return 0;
+    }
+    const size_t bytesToRead = ( pSlot->size < size ) ? pSlot->size : size;
+    return save_decompress( pSlot->data, pSlot->packedSize, (uint8*)buff, bytesToRead );
+}
+
+/**
+ ******************************************************************************
+ * Function
+ ******************************************************************************
+ */
+bool save_slot_write( const int slot, const void* const buff, const size_t size )
+{
+    if ( ( 0 > slot ) || ( SAVE_SLOTS <= slot ) || ( NULL == buff ) || ( 0 == size ) )
+    {
+        return false;
+    }
+    tSaveSlot* const pScratch = SAVE_SLOT( SAVE_SCRATCH_SLOT );
+    const size_t     packedSize = save_compress( (const uint8*)buff, size, pScratch->data, SAVE_DATA_SIZE );
+    if ( 0 == packedSize )
+    {
+        return false;
+    }
+
+    tSaveSlot* const pSlot = SAVE_SLOT( slot );
+
+    // invalidate the slot while it is being written
+    pSlot->magic = 0;
+    memcpy( pSlot->data, pScratch->data, packedSize );
+    pSlot->size       = size;
+    pSlot->packedSize = packedSize;
+    pSlot->checksum   = save_checksum( pSlot->data, packedSize );
+    pSlot->magic      = SAVE_MAGIC;
+    return true;
+}
@@ -0,0 +1,63 @@
+/**
+ ******************************************************************************
+ * Copyright (c) 2023 Husqvarna AB.
+ * All rights reserved.
+ *
+ * This software is licensed under terms that can be found in the LICENSE file
+ * in the root directory of this software component.
+ * If no LICENSE file comes with this software, it is provided AS-IS.
+ *
+ ******************************************************************************
+ */
+
+#ifndef __MY_SAVE_H__
+#define __MY_SAVE_H__
+
+#include <stddef.h>
+#include <stdbool.h>
+
+/*
+ ------------------------------------------------------------------------------
+    Defines
+ ------------------------------------------------------------------------------
+ */
+#define SAVE_SLOTS ( 6 ) // number of savegame slots, matches the DOOM load/save menus
+
+/*
+ ------------------------------------------------------------------------------
+    Interface functions
+ ------------------------------------------------------------------------------
+ */
+/**
+ ******************************************************************************
+ * @brief   Gets the size of the savegame stored in a slot
+ * @param   slot    the savegame slot, 0 to SAVE_SLOTS-1
+ * @return  the uncompressed size in bytes, 0 if the slot holds no valid savegame
+ ******************************************************************************
+ */
+extern size_t save_slot_size( const int slot );
+
+/**
+ ******************************************************************************
+ * @brief   Reads (decompresses) the start of the savegame stored in a slot
+ * @param   slot    the savegame slot, 0 to SAVE_SLOTS-1
+ * @param   buff    buffer receiving the savegame data
+ * @param   size    number of bytes to read, may be less than the savegame size
+ * @return  the number of bytes read, 0 if the slot holds no valid savegame
+ ******************************************************************************
+ */
+extern size_t save_slot_read( const int slot, void* const buff, const size_t size );
+
+/**
+ ******************************************************************************
+ * @brief   Compresses and stores a savegame in a slot
+ *          The previous savegame in the slot is kept if the new one does not fit
+ * @param   slot    the savegame slot, 0 to SAVE_SLOTS-1
+ * @param   buff    the savegame data
+ * @param   size    size of the savegame data in bytes
+ * @return  true if the savegame was stored
+ ******************************************************************************
+ */
+extern bool save_slot_write( const int slot, const void* const buff, const size_t size );
+
+#endif // __MY_SAVE_H__
@@ -88,8 +88,8 @@ void MX_LTDC_Init(void)
     Error_Handler();
   }
   /* USER CODE BEGIN LTDC_Init 2 */
-  // Enable line event callback on line 319
-  HAL_LTDC_ProgramLineEvent(&hltdc, 319);
+  // Enable line event callback at the start of the vertical blanking, the first line after the active area
+  HAL_LTDC_ProgramLineEvent(&hltdc, hltdc.Init.AccumulatedActiveH + 1);
   /* USER CODE END LTDC_Init 2 */
 
 }
@@ -51,12 +51,20 @@ typedef struct
 } tIDraw_Position;
 
 
+/* Pixel data formats */
+typedef enum
+{
+    IDRAW_FORMAT_RGB565 = 0, /* dataRGB565 holds the pixels */
+    IDRAW_FORMAT_L8          /* dataL8 holds the pixels, converted through its CLUT */
+} tIDraw_Format;
+
 /* Image header */
 typedef struct
 {
     uint16              xSize;      /* x pixel size */
     uint16              ySize;      /* y pixel size */
     uint32              totalSize;  /* Total pixel data size in bytes */
+    tIDraw_Format       format;     /* Pixel data format */
 } tIDraw_Header;
 
 /* Pixel data type for RBG 565 format */
@@ -66,12 +74,21 @@ typedef struct
     uint16  pitch;  /* Number of pixels between each row in the image */
 } tIDraw_DataRGB565;
 
+/* Pixel data type for L8 (8-bit CLUT index) format */
+typedef struct
+{
+    uint8*        pData;  /* Pointer to pixel data, one CLUT index per pixel */
+    const uint32* pClut;  /* Pointer to the 256 entry CLUT, ARGB8888, only loaded again when at another address */
+    uint16        pitch;  /* Number of pixels between each row in the image */
+} tIDraw_DataL8;
+
 
 /* Image controlblock */
 typedef struct
 {
     tIDraw_Header header; /* Header */
     tIDraw_DataRGB565          dataRGB565;         /* RGB565 data format */
+    tIDraw_DataL8              dataL8;             /* L8 data format */
 } tIDraw_ControlBlock;
 
 /*
@@ -82,11 +99,16 @@ typedef struct
 
 void IDraw_Init( void );
 void IDraw_Start( void );
-bool IDraw_ImageFromMemory( const void* const address, tIDraw_Position*  pPos);
+bool IDraw_ImageFromMemory( const void* const address, tIDraw_Position*  pPos, tEventCallback eventCallback );
 bool IDraw_FillDisplay( uint32_t colorARGB888 );
 
+/* Fills and draws are queued for the DMA2D, eventCallback (may be NULL) is called from its interrupt when done */
+bool IDraw_Fill( uint32_t colorARGB888, tEventCallback eventCallback );
 bool IDraw_Draw( tIDraw_ControlBlock* pControlBlock, uint16 x, uint16 y, tEventCallback eventCallback );
 
+/* Waits until all queued fills and draws are done */
+void IDraw_Sync( void );
+
 
 #endif /* IDRAW_H */
 
@@ -35,6 +35,12 @@
 #define ILCD_COMMUNICATION_CHECK_PERIOD 10000 //ms
 typedef enum {LCD_ROTATION_NORMAL, LCD_ROTATION_REVERSE} LcdRotation;
 
+/* LCD specific events */
+typedef enum
+{
+    ILCD_EVENT_VERTICAL_BLANK = ( 361 << 16 ) /* Vertical blanking interval started, data counts them */
+} tILCD_Events;
+
 /*
 -------------------------
    Interface functions
@@ -72,6 +78,16 @@ void ILCD_Backlight(bool backlight);
  */
 void ILCD_SetRotation(LcdRotation rotation);
 
+/**
+ ******************************************************************************
+ * @brief   Sets the function called at the start of each vertical blanking
+ *          interval, from the LTDC line interrupt
+ * @param   eventCallback
+ *          called with ILCD_EVENT_VERTICAL_BLANK, NULL for none
+ ******************************************************************************
+ */
+void ILCD_SetVerticalBlankCallback(tEventCallback eventCallback);
+
 /**
  ******************************************************************************
  * @brief   Get LCD Width
@@ -48,4 +48,9 @@ uint8* LCD_GetFrameBuffer();
  */
 uint8* LCD_GetDisplayBuffer();
 
+/**
+ * @brief   Called from the LTDC line interrupt at the start of each vertical blanking interval.
+ */
+void LCD_VerticalBlank( void );
+
 #endif /* LCD_H */
@@ -27,6 +27,7 @@
  ------------------------------------------------------------------------------
  */
 #include "Draw.h"
+#include "IInterrupt.h"
 #include "LCD.h"
 
 #include <stdlib.h>
@@ -40,14 +41,45 @@
  */
 #define GLOBAL_ROTATION 270
 
+#define DRAW_QUEUE_SIZE ( 8 ) // queued DMA2D operations, including the active one
+
+// the DMA2D interrupts a transfer raises, see HAL_DMA2D_IRQHandler
+#define DRAW_TRANSFER_IT ( DMA2D_CR_TCIE | DMA2D_CR_TEIE | DMA2D_CR_CEIE )
+
 /*
 -------------------------------------------------------------------------------
     Local types
 -------------------------------------------------------------------------------
 */
+/* A queued DMA2D operation, a copy (M2M, M2M_PFC) or a fill (R2M) */
+typedef struct
+{
+    uint32_t        mode;           /* DMA2D_M2M, DMA2D_M2M_PFC or DMA2D_R2M */
+    uint32_t        inputColorMode; /* DMA2D_INPUT_xxx, copies only */
+    const uint32_t* pClut;          /* ARGB8888 CLUT of an L8 copy, NULL if none */
+    uint32_t        input;          /* Input address of a copy, RGB565 color of a fill */
+    uint32_t        outputAddress;
+    uint16          width, height;
+    uint16          outputSkip, inputSkip;
+    tEventCallback  eventCallback;
+} tDrawOperation;
+
+/* The configuration the DMA2D holds, only written when an operation needs another one */
+typedef struct
+{
+    uint32_t        mode;
+    uint32_t        inputColorMode;
+    const uint32_t* pClut; /* the CLUT last loaded, a CLUT at another address is loaded again */
+    uint16          outputSkip, inputSkip;
+} tDrawConfig;
+
 typedef struct
 {
-    tEventCallback eventCallback;
+    tDrawOperation   queue[ DRAW_QUEUE_SIZE ]; /* the active operation first */
+    volatile uint8   queueHead;
+    volatile uint8   queueCount;
+    volatile bool    active;
+    tDrawConfig      config;
 } tDrawVars;
 
 /*
@@ -62,12 +94,10 @@ static tDrawVars drawVars;
  Private function prototypes
  ------------------------------------------------------------------------------
  */
-static void DMA2D_Init_M2M( uint32_t pixelFormat,
-                            uint32_t outputAddress,
-                            uint32_t inputAddress,
-                            uint32_t width, uint32_t height,
-                            uint32_t outputSkip,
-                            uint32_t inputSkip );
+static bool DMA2D_Queue( const tDrawOperation* pOperation );
+static void DMA2D_StartNext( void );
+static void DMA2D_Start( const tDrawOperation* pOperation );
+static void DMA2D_Done( uint32 eventId );
 
 // Interrupt callbacks
 void TransferErrorCallback( DMA2D_HandleTypeDef* hdma2d );
@@ -98,6 +128,13 @@ void IDraw_Init( void )
         hdma2d.XferCpltCallback  = &TransferCompleteCallback;
         hdma2d.XferErrorCallback = &TransferErrorCallback;
         MX_DMA2D_Init();
+
+        // the configuration MX_DMA2D_Init() leaves, from here on the DMA2D is only reconfigured when needed
+        drawVars.config.mode           = DMA2D_M2M;
+        drawVars.config.inputColorMode = DMA2D_INPUT_RGB565;
+        drawVars.config.pClut          = NULL;
+        drawVars.config.outputSkip     = 0;
+        drawVars.config.inputSkip      = 0;
     }
 }
 
@@ -126,17 +163,18 @@ void IDraw_Start( void )
  * Function
  ******************************************************************************
  */
-bool IDraw_ImageFromMemory( const void* const address, tIDraw_Position* pPos )
+bool IDraw_ImageFromMemory( const void* const address, tIDraw_Position* pPos, tEventCallback eventCallback )
 {
     tIDraw_ControlBlock cb;
     cb.header.xSize     = 320;
     cb.header.ySize     = 200;
     cb.header.totalSize = 320 * 200 * 2;
+    cb.header.format    = IDRAW_FORMAT_RGB565;
 
     cb.dataRGB565.pData = (uint16*)address;
     cb.dataRGB565.pitch = 320;
 
-    if ( !IDraw_Draw( &cb, pPos->x, pPos->y, NULL ) )
+    if ( !IDraw_Draw( &cb, pPos->x, pPos->y, eventCallback ) )
     {
         return false;
     }
@@ -150,22 +188,49 @@ bool IDraw_ImageFromMemory( const void* const address, tIDraw_Position* pPos )
  */
 bool IDraw_FillDisplay( uint32_t colorARGB888 )
 {
-    // Use DMA2D to fill display with black using R2M
-    HAL_DMA2D_DeInit( &hdma2d );
-    hdma2d.Init.Mode         = DMA2D_R2M;
-    hdma2d.Init.ColorMode    = DMA2D_OUTPUT_RGB565;
-    hdma2d.Init.OutputOffset = 0;
-    HAL_DMA2D_Init( &hdma2d );
-
-    // Start DMA2D transfer
-    HAL_DMA2D_Start( &hdma2d, colorARGB888, ltdc_frame_buffer, IMAGE_WIDTH, IMAGE_HEIGHT );
-    // Reload display
-    HAL_LTDC_Reload( &hltdc, LTDC_RELOAD_IMMEDIATE );
-
-    HAL_Delay( 1 ); // Delay for just a millisecond to allow display to clear. Should prob. be done with callbacks from interrupt.
+    if ( !IDraw_Fill( colorARGB888, NULL ) )
+    {
+        return false;
+    }
+    IDraw_Sync();
     return true;
 }
 
+/*
+ ******************************************************************************
+ * Function
+ ******************************************************************************
+ */
+bool IDraw_Fill( uint32_t colorARGB888, tEventCallback eventCallback )
+{
+    // Use DMA2D to fill the display using R2M, the color converted to the RGB565 output
+    tDrawOperation operation;
+    operation.mode           = DMA2D_R2M;
+    operation.inputColorMode = DMA2D_INPUT_RGB565;
+    operation.pClut          = NULL;
+    operation.input          = ( ( ( colorARGB888 >> 19 ) & 0x1F ) << 11 ) | ( ( ( colorARGB888 >> 10 ) & 0x3F ) << 5 ) | ( ( colorARGB888 >> 3 ) & 0x1F );
+    operation.outputAddress  = ltdc_frame_buffer;
+    operation.width          = IMAGE_WIDTH;
+    operation.height         = IMAGE_HEIGHT;
+    operation.outputSkip     = 0;
+    operation.inputSkip      = 0;
+    operation.eventCallback  = eventCallback;
+    return DMA2D_Queue( &operation );
+}
+
+/*
+ ******************************************************************************
+ * Function
+ ******************************************************************************
+ */
+void IDraw_Sync( void )
+{
+    while ( drawVars.active )
+    {
+        // wait for the DMA2D interrupt
+    }
+}
+
 /*
  ******************************************************************************
  * Function
@@ -259,8 +324,6 @@ bool IDraw_Draw( tIDraw_ControlBlock* pControlBlock,
         y1 = 0;
     }
 
-    drawVars.eventCallback = eventCallback;
-
     // Get initial output frame buffer for DMA2D
     uint32 fb = (uint32)ltdc_frame_buffer;
 
@@ -273,19 +336,32 @@ bool IDraw_Draw( tIDraw_ControlBlock* pControlBlock,
         return false;
     }
 
-    // Set up input address and frame buffer
-    uint32 inputAddress = (uint32)pControlBlock->dataRGB565.pData + (uint32)delta * FRAMEBUFFER_BPP * physicalImageWidth;
+    // Set up input address and format, L8 is converted through its CLUT on the way
+    tDrawOperation operation;
+    if ( IDRAW_FORMAT_L8 == pControlBlock->header.format )
+    {
+        operation.mode           = DMA2D_M2M_PFC;
+        operation.inputColorMode = DMA2D_INPUT_L8;
+        operation.pClut          = pControlBlock->dataL8.pClut;
+        operation.input          = (uint32)pControlBlock->dataL8.pData + (uint32)delta * physicalImageWidth;
+    }
+    else
+    {
+        operation.mode           = DMA2D_M2M;
+        operation.inputColorMode = DMA2D_INPUT_RGB565;
+        operation.pClut          = NULL;
+        operation.input          = (uint32)pControlBlock->dataRGB565.pData + (uint32)delta * FRAMEBUFFER_BPP * physicalImageWidth;
+    }
+    operation.outputAddress = outputAddress;
+    operation.width         = imageWidth;
+    operation.height        = imageHeight;
+    // Skips are counted as a pixel, not as memory amount
+    operation.outputSkip    = IMAGE_WIDTH - imageWidth;
+    operation.inputSkip     = physicalImageWidth - imageWidth;
+    operation.eventCallback = eventCallback;
 
     // Send to DMA2D for transfer/handling
-    DMA2D_Init_M2M( DMA2D_RGB565,
-                    outputAddress,
-                    inputAddress,
-                    imageWidth, imageHeight,
-                    // Skips are counted as a pixel, not as memory amount
-                    IMAGE_WIDTH - imageWidth,
-                    physicalImageWidth - imageWidth );
-
-    return true;
+    return DMA2D_Queue( &operation );
 }
 
 /*
@@ -299,33 +375,132 @@ bool IDraw_Draw( tIDraw_ControlBlock* pControlBlock,
  * Function
  ******************************************************************************
  */
-static void DMA2D_Init_M2M( uint32_t pixelFormat,
-                            uint32_t outputAddress,
-                            uint32_t inputAddress,
-                            uint32_t width, uint32_t height,
-                            uint32_t outputSkip,
-                            uint32_t inputSkip )
+static bool DMA2D_Queue( const tDrawOperation* pOperation )
+{
+    bool queued = false;
+
+    // operations are queued from the application and from interrupts (transfer callbacks)
+    IInterrupt_GlobalDisable();
+    if ( DRAW_QUEUE_SIZE > drawVars.queueCount )
+    {
+        drawVars.queue[ ( drawVars.queueHead + drawVars.queueCount ) % DRAW_QUEUE_SIZE ] = *pOperation;
+        drawVars.queueCount++;
+        queued = true;
+        DMA2D_StartNext();
+    }
+    IInterrupt_GlobalEnable();
+
+    return queued;
+}
+
+/*
+ ******************************************************************************
+ * Function
+ ******************************************************************************
+ */
+static void DMA2D_StartNext( void )
+{
+    // called with interrupts disabled, or from the DMA2D interrupt
+    if ( !drawVars.active && ( 0 < drawVars.queueCount ) )
+    {
+        drawVars.active = true;
+        DMA2D_Start( &drawVars.queue[ drawVars.queueHead ] );
+    }
+}
+
+/*
+ ******************************************************************************
+ * Function
+ ******************************************************************************
+ */
+static void DMA2D_Start( const tDrawOperation* pOperation )
 {
-    /* Initialize DMA2D for memory to memory mode (copy pixels from source to destination memory). */
-    /* DMA2D configuration */
-    HAL_DMA2D_DeInit( &hdma2d );
-    hdma2d.Init.Mode         = DMA2D_M2M;
-    hdma2d.Init.ColorMode    = pixelFormat;
-    hdma2d.Init.OutputOffset = outputSkip;
-    if ( HAL_DMA2D_Init( &hdma2d ) != HAL_OK )
+    DMA2D_TypeDef* const pDma2d  = hdma2d.Instance;
+    tDrawConfig* const   pConfig = &drawVars.config;
+
+    /* Reconfigure only what differs from the previous operation */
+    if ( pConfig->mode != pOperation->mode )
     {
-        Error_Handler();
+        MODIFY_REG( pDma2d->CR, DMA2D_CR_MODE, pOperation->mode );
+        pConfig->mode = pOperation->mode;
+    }
+    if ( pConfig->outputSkip != pOperation->outputSkip )
+    {
+        pDma2d->OOR         = pOperation->outputSkip;
+        pConfig->outputSkip = pOperation->outputSkip;
     }
 
-    /* Layer config*/
-    hdma2d.LayerCfg[ 1 ].InputOffset = inputSkip;
-    if ( HAL_DMA2D_ConfigLayer( &hdma2d, 1 ) != HAL_OK )
+    if ( DMA2D_R2M == pOperation->mode )
+    {
+        pDma2d->OCOLR = pOperation->input;
+    }
+    else
     {
-        Error_Handler();
+        if ( pConfig->inputColorMode != pOperation->inputColorMode )
+        {
+            MODIFY_REG( pDma2d->FGPFCCR, DMA2D_FGPFCCR_CM, pOperation->inputColorMode );
+            pConfig->inputColorMode = pOperation->inputColorMode;
+        }
+        if ( pConfig->inputSkip != pOperation->inputSkip )
+        {
+            pDma2d->FGOR       = pOperation->inputSkip;
+            pConfig->inputSkip = pOperation->inputSkip;
+        }
+
+        /* CLUT for the pixel format conversion, loaded (it is only 1 KB) before the transfer */
+        if ( ( NULL != pOperation->pClut ) && ( pConfig->pClut != pOperation->pClut ) )
+        {
+            pDma2d->FGCMAR = (uint32_t)pOperation->pClut;
+            MODIFY_REG( pDma2d->FGPFCCR,
+                        DMA2D_FGPFCCR_CS | DMA2D_FGPFCCR_CCM,
+                        ( 255u << DMA2D_FGPFCCR_CS_Pos ) | ( DMA2D_CCM_ARGB8888 << DMA2D_FGPFCCR_CCM_Pos ) ); // entries - 1
+            pDma2d->FGPFCCR |= DMA2D_FGPFCCR_START;
+            while ( 0 != ( pDma2d->FGPFCCR & DMA2D_FGPFCCR_START ) )
+            {
+                // wait for the CLUT to be loaded
+            }
+            pDma2d->IFCR   = DMA2D_IFCR_CCTCIF;
+            pConfig->pClut = pOperation->pClut;
+        }
+        pDma2d->FGMAR = pOperation->input;
     }
 
-    /* Start DMA2D transfer*/
-    HAL_DMA2D_Start_IT( &hdma2d, inputAddress, outputAddress, width, height );
+    /* Re-arm the DMA2D with the addresses and size, and start the transfer */
+    pDma2d->OMAR = pOperation->outputAddress;
+    pDma2d->NLR  = ( (uint32_t)pOperation->width << DMA2D_NLR_PL_Pos ) | pOperation->height;
+    pDma2d->IFCR = DMA2D_IFCR_CTCIF | DMA2D_IFCR_CTEIF | DMA2D_IFCR_CCEIF;
+    pDma2d->CR |= DRAW_TRANSFER_IT | DMA2D_CR_START;
+}
+
+/*
+ ******************************************************************************
+ * Function
+ ******************************************************************************
+ */
+static void DMA2D_Done( uint32 eventId )
+{
+    // called from the DMA2D interrupt, when the active operation is done (or failed);
+    // a further error flag of the same interrupt finds the next operation running
+    if ( !drawVars.active || ( 0 != ( hdma2d.Instance->CR & DMA2D_CR_START ) ) )
+    {
+        return;
+    }
+    const tEventCallback eventCallback = drawVars.queue[ drawVars.queueHead ].eventCallback;
+
+    hdma2d.Instance->CR &= ~DRAW_TRANSFER_IT;
+    drawVars.queueHead = ( drawVars.queueHead + 1 ) % DRAW_QUEUE_SIZE;
+    drawVars.queueCount--;
+    drawVars.active = false;
+
+    // keep the DMA2D busy, before the callback queues more
+    DMA2D_StartNext();
+
+    if ( NULL != eventCallback )
+    {
+        tEvent sendEvent;
+        sendEvent.id = eventId;
+        eventCallback( sendEvent );
+    }
 }
 
 /*
@@ -341,12 +516,7 @@ static void DMA2D_Init_M2M( uint32_t pixelFormat,
 void TransferErrorCallback( DMA2D_HandleTypeDef* hdma2d )
 {
     // DMA2D transfer error callback
-    if ( NULL != drawVars.eventCallback )
-    {
-        tEvent sendEvent;
-        sendEvent.id = IDRAW_EVENT_FAILED;
-        drawVars.eventCallback( sendEvent );
-    }
+    DMA2D_Done( IDRAW_EVENT_FAILED );
 }
 
 /*
@@ -357,10 +527,5 @@ void TransferErrorCallback( DMA2D_HandleTypeDef* hdma2d )
 void TransferCompleteCallback( DMA2D_HandleTypeDef* hdma2d )
 {
     // DMA2D transfer completed callback
-    if ( NULL != drawVars.eventCallback )
-    {
-        tEvent sendEvent;
-        sendEvent.id = IDRAW_EVENT_DONE;
-        drawVars.eventCallback( sendEvent );
-    }
+    DMA2D_Done( IDRAW_EVENT_DONE );
 }
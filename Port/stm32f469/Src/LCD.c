@@ -42,6 +42,9 @@ typedef struct
 
 static bool FBSwapped;
 
+static tEventCallback verticalBlankCallback = NULL;
+static uint32         verticalBlanks        = 0;
+
 void ILCD_Init( void )
 {
     static bool initialized = FALSE;
@@ -96,6 +99,23 @@ void ILCD_SetRotation( LcdRotation rotation )
     LCD_SetRotation( &lcdControllerConfig, &rotation );
 }
 
+void ILCD_SetVerticalBlankCallback( tEventCallback eventCallback )
+{
+    verticalBlankCallback = eventCallback;
+}
+
+void LCD_VerticalBlank( void )
+{
+    verticalBlanks++;
+    if ( NULL != verticalBlankCallback )
+    {
+        tEvent event;
+        event.id   = ILCD_EVENT_VERTICAL_BLANK;
+        event.data = verticalBlanks;
+        verticalBlankCallback( event );
+    }
+}
+
 uint32 LCD_GetDisplayId( void )
 {
     return LCD_ReadDisplayId( &lcdControllerConfig );
@@ -83,6 +83,7 @@
 typedef struct
 {
     LcdRotation rotationST7789VI;
+    bool        rotationChanged; /* to be sent at the next vertical blanking */
     tISpiDevice spiST7789VI;
 } tLcdVars;
 /*
@@ -100,6 +101,7 @@ static tLcdVars lcdVars     = { 0 };
  */
 static void LCD_send( tISpiDevice device, Spi_CD cdBit, uint8_t byte, uint16_t delay );
 static void LCD_read( tISpiDevice device, uint8_t command, uint16_t count, uint8_t* buffer );
+static void LCD_sendRotation( void );
 
 /*
  ------------------------------
@@ -122,6 +124,7 @@ void LCD_InitSequence( tLcdST7789VICfg* config )
 
     LCD_send( lcd, CMD, ST7789H2_MAD_CTRL_W, 0 );
     LCD_send( lcd, DATA, 0x14, 0 ); // Rotate display, RGB order
+    lcdVars.rotationST7789VI = LCD_ROTATION_REVERSE;
 
     LCD_send( lcd, CMD, ST7789H2_COLOR_MODE_W, 0 );
     LCD_send( lcd, DATA, 0x55, 0 ); // 16 bit color on RGB and control interface
@@ -218,8 +221,12 @@ uint32_t LCD_ReadDisplayId( tLcdST7789VICfg* config )
 
 void LCD_SetRotation( tLcdST7789VICfg* config, const LcdRotation* rotation )
 {
-    lcdVars.rotationST7789VI = *rotation;
-    lcdVars.spiST7789VI      = config->interface;
+    if ( *rotation != lcdVars.rotationST7789VI )
+    {
+        lcdVars.spiST7789VI      = config->interface;
+        lcdVars.rotationST7789VI = *rotation;
+        lcdVars.rotationChanged  = true;
+    }
 }
 
 /* LTDC interrupt callbacks */
@@ -229,27 +236,17 @@ void HAL_LTDC_ErrorCallback( LTDC_HandleTypeDef* hltdc )
 
 void HAL_LTDC_LineEventCallback( LTDC_HandleTypeDef* hltdc )
 {
-    if ( false == initialized )
+    // the line event is at the start of the vertical blanking (see MX_LTDC_Init()), the HAL disables it each time
+    HAL_LTDC_ProgramLineEvent( hltdc, hltdc->Init.AccumulatedActiveH + 1 );
+
+    // a new rotation is only sent between frames
+    if ( initialized && lcdVars.rotationChanged )
     {
-        return;
+        lcdVars.rotationChanged = false;
+        LCD_sendRotation();
     }
-    switch ( lcdVars.rotationST7789VI )
-    {
-        case LCD_ROTATION_NORMAL:
-            LCD_send( lcdVars.spiST7789VI, CMD, ST7789H2_MAD_CTRL_W, 0 );
-            LCD_send( lcdVars.spiST7789VI, DATA, 0x00, 0 ); // 270 rotate respect to default display orientation
-            break;
-
-        case LCD_ROTATION_REVERSE:
-            LCD_send( lcdVars.spiST7789VI, CMD, ST7789H2_MAD_CTRL_W, 0 );
-            LCD_send( lcdVars.spiST7789VI, DATA, 0x14, 0 ); // 90 rotate respect to default display orientation
-            break;
 
-        default:
-            LCD_send( lcdVars.spiST7789VI, CMD, ST7789H2_MAD_CTRL_W, 0 );
-            LCD_send( lcdVars.spiST7789VI, DATA, 0x00, 0 ); // 270 rotate respect to default display orientation
-            break;
-    }
+    LCD_VerticalBlank();
 }
 
 void HAL_LTDC_ReloadEventCallback( LTDC_HandleTypeDef* hltdc )
@@ -307,7 +304,34 @@ static void LCD_send( tISpiDevice device, Spi_CD cdBit, uint8_t byte, uint16_t d
     ISpi_SendDC( device, cdBit );
     ISpi_TxRx( device, byte, &dummy );
     ISpi_StopTransfer( device );
-    HAL_Delay( delay );
+    if ( 0 < delay )
+    {
+        HAL_Delay( delay ); // HAL_Delay( 0 ) still waits a tick, which may never come in an interrupt
+    }
+}
+
+/**
+ * Send the MADCTL command for the current rotation.
+ */
+static void LCD_sendRotation( void )
+{
+    switch ( lcdVars.rotationST7789VI )
+    {
+        case LCD_ROTATION_NORMAL:
+            LCD_send( lcdVars.spiST7789VI, CMD, ST7789H2_MAD_CTRL_W, 0 );
+            LCD_send( lcdVars.spiST7789VI, DATA, 0x00, 0 ); // 270 rotate respect to default display orientation
+            break;
+
+        case LCD_ROTATION_REVERSE:
+            LCD_send( lcdVars.spiST7789VI, CMD, ST7789H2_MAD_CTRL_W, 0 );
+            LCD_send( lcdVars.spiST7789VI, DATA, 0x14, 0 ); // 90 rotate respect to default display orientation
+            break;
+
+        default:
+            LCD_send( lcdVars.spiST7789VI, CMD, ST7789H2_MAD_CTRL_W, 0 );
+            LCD_send( lcdVars.spiST7789VI, DATA, 0x00, 0 ); // 270 rotate respect to default display orientation
+            break;
+    }
 }
 
 /**
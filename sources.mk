@@ -41,6 +41,7 @@ SOURCE_FILES += Port/stm32f469/Src/SystemTick.c
 SOURCE_FILES += Port/stm32f469/Src/Watchdog.c
 SOURCE_FILES += Port/stm32f469/Adapter/myff.c
 SOURCE_FILES += Port/stm32f469/Adapter/mylcd.c
+SOURCE_FILES += Port/stm32f469/Adapter/mysave.c
 SOURCE_FILES += Port/stm32f469/Adapter/mymain.c
 
 # CUBEMX configs
@@ -0,0 +1,480 @@
+//
+// Copyright(C) 2023 Husqvarna AB
+//
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU General Public License
+// as published by the Free Software Foundation; either version 2
+// of the License, or (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+
+/**
+ ******************************************************************************
+ * @file      MockDma2d.c
+ *
+ * @copyright Copyright (c) Husqvarna AB
+ *
+ * @brief     Register-level DMA2D for host tests. A thread plays the DMA2D:
+ *            it loads the CLUT when FGPFCCR.START is set, runs the transfer
+ *            when CR.START is set (M2M and M2M_PFC from RGB565 or L8 input,
+ *            R2M, RGB565 output), and raises the interrupt, which another
+ *            thread takes through HAL_DMA2D_IRQHandler(), so the DMA2D runs
+ *            on while the interrupt waits for it, as the hardware does
+ ******************************************************************************
+ */
+/*
+ ------------------------------------------------------------------------------
+ Include files
+ ------------------------------------------------------------------------------
+ */
+#include "MockHardware.h"
+
+#include <pthread.h>
+#include <semaphore.h>
+#include <string.h>
+#include <sys/resource.h>
+#include <sys/syscall.h>
+#include <time.h>
+#include <unistd.h>
+
+/*
+ ------------------------------------------------------------------------------
+ Local defines
+ ------------------------------------------------------------------------------
+ */
+#define MOCK_DMA2D_POLL_NS  ( 10000 )  // how often the idle DMA2D looks at its registers
+#define MOCK_DMA2D_AHEAD_NS ( 200000 ) // how far a timed transfer may get ahead, host sleeps are coarse
+
+// the DMA2D interrupts, flag and enable bit
+#define MOCK_DMA2D_IT( pDma2d, flag, enable ) ( ( 0 != ( ( pDma2d )->ISR & ( flag ) ) ) && ( 0 != ( ( pDma2d )->CR & ( enable ) ) ) )
+
+/*
+-------------------------------------------------------------------------------
+    Local types
+-------------------------------------------------------------------------------
+*/
+/* The registers of a transfer, which must not change while it runs */
+typedef struct
+{
+    uint32_t cr;
+    uint32_t fgmar, fgor, fgpfccr;
+    uint32_t ocolr, omar, oor, nlr;
+} tMockDma2dTransfer;
+
+/*
+ ------------------------------------------------------------------------------
+ Private data
+ ------------------------------------------------------------------------------
+ */
+DMA2D_TypeDef       mockDma2d;
+DMA2D_HandleTypeDef hdma2d;
+
+static volatile bool     mockHold      = false;
+static volatile bool     mockFailNext  = false;
+static volatile uint32_t mockPixelTime = 0;
+static tMockDma2dStats   mockStats;
+static sem_t             mockInterrupt; // posted when the DMA2D raises its interrupt
+
+/*
+ ------------------------------------------------------------------------------
+ Private function prototypes
+ ------------------------------------------------------------------------------
+ */
+static void* MockDma2d_Run( void* pArg );
+static void* MockDma2d_Interrupt( void* pArg );
+static void  MockDma2d_LoadClut( void );
+static void  MockDma2d_Transfer( void );
+static bool  MockDma2d_ConfigError( const tMockDma2dTransfer* pTransfer );
+static uint32_t MockDma2d_SourceHash( const tMockDma2dTransfer* pTransfer );
+static void  MockDma2d_Complete( uint32_t flag );
+static void  MockDma2d_Sleep( const struct timespec* pStart, uint64_t ns, uint64_t ahead );
+
+/*
+ ------------------------------------------------------------------------------
+ Implementation of interface functions
+ ------------------------------------------------------------------------------
+ */
+/*
+ ******************************************************************************
+ * Function
+ ******************************************************************************
+ */
+void MX_DMA2D_Init( void )
+{
+    static bool started = false;
+    pthread_t   thread;
+
+    // the configuration HAL_DMA2D_Init() and HAL_DMA2D_ConfigLayer() leave
+    memset( &mockDma2d, 0, sizeof( mockDma2d ) );
+    hdma2d.Instance = DMA2D;
+    MODIFY_REG( mockDma2d.CR, DMA2D_CR_MODE, DMA2D_M2M );
+    mockDma2d.OPFCCR  = DMA2D_OUTPUT_RGB565;
+    mockDma2d.OOR     = 0;
+    mockDma2d.FGPFCCR = DMA2D_INPUT_RGB565;
+    mockDma2d.FGOR    = 0;
+
+    if ( !started )
+    {
+        started = true;
+        sem_init( &mockInterrupt, 0, 0 );
+        pthread_create( &thread, NULL, &MockDma2d_Run, NULL );
+        pthread_detach( thread );
+        pthread_create( &thread, NULL, &MockDma2d_Interrupt, NULL );
+        pthread_detach( thread );
+
+        // interrupts preempt the application, which waits for them in busy loops
+        setpriority( PRIO_PROCESS, (id_t)syscall( SYS_gettid ), 19 );
+    }
+}
+
+/*
+ ******************************************************************************
+ * Function
+ ******************************************************************************
+ */
+void HAL_DMA2D_IRQHandler( DMA2D_HandleTypeDef* hdma2d )
+{
+    DMA2D_TypeDef* const pDma2d = hdma2d->Instance;
+
+    // the flags in the order of the HAL; the DMA2D sets flags meanwhile, the IFCR writes clear at once
+    if ( MOCK_DMA2D_IT( pDma2d, DMA2D_ISR_TEIF, DMA2D_CR_TEIE ) )
+    {
+        pDma2d->CR &= ~DMA2D_CR_TEIE;
+        __atomic_fetch_and( &pDma2d->ISR, ~DMA2D_ISR_TEIF, __ATOMIC_SEQ_CST );
+        hdma2d->XferErrorCallback( hdma2d );
+    }
+    if ( MOCK_DMA2D_IT( pDma2d, DMA2D_ISR_CEIF, DMA2D_CR_CEIE ) )
+    {
+        pDma2d->CR &= ~DMA2D_CR_CEIE;
+        __atomic_fetch_and( &pDma2d->ISR, ~DMA2D_ISR_CEIF, __ATOMIC_SEQ_CST );
+        hdma2d->XferErrorCallback( hdma2d );
+    }
+    if ( MOCK_DMA2D_IT( pDma2d, DMA2D_ISR_TCIF, DMA2D_CR_TCIE ) )
+    {
+        pDma2d->CR &= ~DMA2D_CR_TCIE;
+        __atomic_fetch_and( &pDma2d->ISR, ~DMA2D_ISR_TCIF, __ATOMIC_SEQ_CST );
+        hdma2d->XferCpltCallback( hdma2d );
+    }
+}
+
+/*
+ ******************************************************************************
+ * Function
+ ******************************************************************************
+ */
+void MockDma2d_GetStats( tMockDma2dStats* pStats )
+{
+    __atomic_thread_fence( __ATOMIC_SEQ_CST );
+    *pStats = mockStats;
+}
+
+/*
+ ******************************************************************************
+ * Function
+ ******************************************************************************
+ */
+void MockDma2d_Hold( bool hold )
+{
+    mockHold = hold;
+}
+
+/*
+ ******************************************************************************
+ * Function
+ ******************************************************************************
+ */
+void MockDma2d_FailNext( void )
+{
+    mockFailNext = true;
+}
+
+/*
+ ******************************************************************************
+ * Function
+ ******************************************************************************
+ */
+void MockDma2d_SetPixelTime( uint32_t ns )
+{
+    mockPixelTime = ns;
+}
+
+/*
+ -------------------------------------------------------------------------------
+ Implementation of private functions
+ -------------------------------------------------------------------------------
+ */
+
+/*
+ ******************************************************************************
+ * Function
+ ******************************************************************************
+ */
+static void* MockDma2d_Run( void* pArg )
+{
+    const struct timespec poll = { 0, MOCK_DMA2D_POLL_NS };
+    (void)pArg;
+
+    for ( ;; )
+    {
+        // flags written to IFCR are cleared
+        __atomic_fetch_and( &mockDma2d.ISR, ~__atomic_exchange_n( &mockDma2d.IFCR, 0, __ATOMIC_SEQ_CST ), __ATOMIC_SEQ_CST );
+
+        if ( 0 != ( mockDma2d.FGPFCCR & DMA2D_FGPFCCR_START ) )
+        {
+            MockDma2d_LoadClut();
+        }
+        else if ( ( 0 != ( mockDma2d.CR & DMA2D_CR_START ) ) && !mockHold )
+        {
+            MockDma2d_Transfer();
+        }
+        else
+        {
+            nanosleep( &poll, NULL );
+        }
+    }
+    return NULL;
+}
+
+/*
+ ******************************************************************************
+ * Function
+ ******************************************************************************
+ */
+static void* MockDma2d_Interrupt( void* pArg )
+{
+    (void)pArg;
+
+    for ( ;; )
+    {
+        while ( 0 != sem_wait( &mockInterrupt ) )
+        {
+            // interrupted, wait on
+        }
+        MockInterrupt_Enter();
+        HAL_DMA2D_IRQHandler( &hdma2d );
+        MockInterrupt_Exit();
+    }
+    return NULL;
+}
+
+/*
+ ******************************************************************************
+ * Function
+ ******************************************************************************
+ */
+static void MockDma2d_LoadClut( void )
+{
+    const uint32_t* const pClut   = (const uint32_t*)(uintptr_t)mockDma2d.FGCMAR;
+    const uint32_t        entries = ( ( mockDma2d.FGPFCCR & DMA2D_FGPFCCR_CS ) >> DMA2D_FGPFCCR_CS_Pos ) + 1;
+
+    if ( DMA2D_CCM_ARGB8888 != ( ( mockDma2d.FGPFCCR & DMA2D_FGPFCCR_CCM ) >> DMA2D_FGPFCCR_CCM_Pos ) )
+    {
+        mockStats.configErrors++;
+    }
+    for ( uint32_t i = 0; i < entries; i++ )
+    {
+        mockDma2d.FGCLUT[ i ] = pClut[ i ];
+    }
+    mockStats.clutLoads++;
+
+    __atomic_fetch_or( &mockDma2d.ISR, DMA2D_ISR_CTCIF, __ATOMIC_SEQ_CST );
+    __atomic_fetch_and( &mockDma2d.FGPFCCR, ~DMA2D_FGPFCCR_START, __ATOMIC_SEQ_CST );
+}
+
+/*
+ ******************************************************************************
+ * Function
+ ******************************************************************************
+ */
+static void MockDma2d_Transfer( void )
+{
+    tMockDma2dTransfer transfer;
+    struct timespec    start;
+
+    transfer.cr      = mockDma2d.CR;
+    transfer.fgmar   = mockDma2d.FGMAR;
+    transfer.fgor    = mockDma2d.FGOR;
+    transfer.fgpfccr = mockDma2d.FGPFCCR;
+    transfer.ocolr   = mockDma2d.OCOLR;
+    transfer.omar    = mockDma2d.OMAR;
+    transfer.oor     = mockDma2d.OOR;
+    transfer.nlr     = mockDma2d.NLR;
+
+    const uint32_t mode   = transfer.cr & DMA2D_CR_MODE;
+    const uint32_t input  = transfer.fgpfccr & DMA2D_FGPFCCR_CM;
+    const uint32_t width  = ( transfer.nlr & DMA2D_NLR_PL ) >> DMA2D_NLR_PL_Pos;
+    const uint32_t height = transfer.nlr & DMA2D_NLR_NL;
+
+    mockStats.transfers++;
+    if ( DMA2D_R2M == mode )
+    {
+        mockStats.fills++;
+    }
+
+    if ( MockDma2d_ConfigError( &transfer ) )
+    {
+        mockStats.configErrors++;
+        MockDma2d_Complete( DMA2D_ISR_CEIF );
+        return;
+    }
+    if ( mockFailNext )
+    {
+        mockFailNext = false;
+        MockDma2d_Complete( DMA2D_ISR_TEIF );
+        return;
+    }
+
+    const uint32_t hash = MockDma2d_SourceHash( &transfer );
+    clock_gettime( CLOCK_MONOTONIC, &start );
+
+    for ( uint32_t line = 0; line < height; line++ )
+    {
+        uint16_t* const pOut = (uint16_t*)(uintptr_t)transfer.omar + line * ( width + ( transfer.oor & DMA2D_OOR_LO ) );
+        const uint32_t  in   = line * ( width + ( transfer.fgor & DMA2D_FGOR_LO ) );
+
+        for ( uint32_t x = 0; x < width; x++ )
+        {
+            if ( DMA2D_R2M == mode )
+            {
+                pOut[ x ] = (uint16_t)transfer.ocolr;
+            }
+            else if ( DMA2D_INPUT_L8 == input )
+            {
+                const uint32_t argb = mockDma2d.FGCLUT[ ( (const uint8_t*)(uintptr_t)transfer.fgmar )[ in + x ] ];
+                pOut[ x ]           = ( ( argb >> 8 ) & 0xF800 ) | ( ( argb >> 5 ) & 0x07E0 ) | ( ( argb >> 3 ) & 0x001F );
+            }
+            else
+            {
+                pOut[ x ] = ( (const uint16_t*)(uintptr_t)transfer.fgmar )[ in + x ];
+            }
+        }
+
+        MockLcd_RowWritten( (uint32_t)(uintptr_t)pOut );
+
+        if ( 0 != mockPixelTime )
+        {
+            MockDma2d_Sleep( &start, (uint64_t)( line + 1 ) * width * mockPixelTime, MOCK_DMA2D_AHEAD_NS );
+        }
+    }
+    if ( 0 != mockPixelTime )
+    {
+        MockDma2d_Sleep( &start, (uint64_t)height * width * mockPixelTime, 0 );
+    }
+
+    // the registers of the transfer, and its source, are left alone until it is done
+    if ( ( ( transfer.cr ^ mockDma2d.CR ) & ~DMA2D_CR_START ) || ( transfer.fgmar != mockDma2d.FGMAR ) ||
+         ( transfer.fgor != mockDma2d.FGOR ) || ( transfer.fgpfccr != mockDma2d.FGPFCCR ) ||
+         ( transfer.ocolr != mockDma2d.OCOLR ) || ( transfer.omar != mockDma2d.OMAR ) ||
+         ( transfer.oor != mockDma2d.OOR ) || ( transfer.nlr != mockDma2d.NLR ) )
+    {
+        mockStats.busyWrites++;
+    }
+    if ( hash != MockDma2d_SourceHash( &transfer ) )
+    {
+        mockStats.sourceWrites++;
+    }
+
+    MockDma2d_Complete( DMA2D_ISR_TCIF );
+}
+
+/*
+ ******************************************************************************
+ * Function
+ ******************************************************************************
+ */
+static bool MockDma2d_ConfigError( const tMockDma2dTransfer* pTransfer )
+{
+    const uint32_t mode  = pTransfer->cr & DMA2D_CR_MODE;
+    const uint32_t input = pTransfer->fgpfccr & DMA2D_FGPFCCR_CM;
+
+    if ( ( 0 == ( pTransfer->nlr & DMA2D_NLR_PL ) ) || ( 0 == ( pTransfer->nlr & DMA2D_NLR_NL ) ) )
+    {
+        return true;
+    }
+    if ( DMA2D_OUTPUT_RGB565 != ( mockDma2d.OPFCCR & DMA2D_OPFCCR_CM ) )
+    {
+        return true;
+    }
+    switch ( mode )
+    {
+        case DMA2D_R2M:
+            return false;
+        case DMA2D_M2M:
+            // no conversion, the input must be in the output format
+            return DMA2D_INPUT_RGB565 != input;
+        case DMA2D_M2M_PFC:
+            return ( DMA2D_INPUT_RGB565 != input ) && ( DMA2D_INPUT_L8 != input );
+        default:
+            return true;
+    }
+}
+
+/*
+ ******************************************************************************
+ * Function
+ ******************************************************************************
+ */
+static uint32_t MockDma2d_SourceHash( const tMockDma2dTransfer* pTransfer )
+{
+    const uint32_t width  = ( pTransfer->nlr & DMA2D_NLR_PL ) >> DMA2D_NLR_PL_Pos;
+    const uint32_t height = pTransfer->nlr & DMA2D_NLR_NL;
+    const uint32_t bpp    = ( DMA2D_INPUT_L8 == ( pTransfer->fgpfccr & DMA2D_FGPFCCR_CM ) ) ? 1 : 2;
+    uint32_t       hash   = 2166136261u;
+
+    if ( DMA2D_R2M == ( pTransfer->cr & DMA2D_CR_MODE ) )
+    {
+        return 0;
+    }
+    // FNV-1a of the pixels read
+    for ( uint32_t line = 0; line < height; line++ )
+    {
+        const volatile uint8_t* pIn = (const volatile uint8_t*)(uintptr_t)pTransfer->fgmar +
+                                      line * ( width + ( pTransfer->fgor & DMA2D_FGOR_LO ) ) * bpp;
+        for ( uint32_t i = 0; i < width * bpp; i++ )
+        {
+            hash = ( hash ^ pIn[ i ] ) * 16777619u;
+        }
+    }
+    return hash;
+}
+
+/*
+ ******************************************************************************
+ * Function
+ ******************************************************************************
+ */
+static void MockDma2d_Complete( uint32_t flag )
+{
+    __atomic_fetch_or( &mockDma2d.ISR, flag, __ATOMIC_SEQ_CST );
+    __atomic_fetch_and( &mockDma2d.CR, ~DMA2D_CR_START, __ATOMIC_SEQ_CST );
+    sem_post( &mockInterrupt );
+}
+
+/*
+ ******************************************************************************
+ * Function
+ ******************************************************************************
+ */
+static void MockDma2d_Sleep( const struct timespec* pStart, uint64_t ns, uint64_t ahead )
+{
+    struct timespec now;
+    struct timespec until;
+
+    // sleeps until ns after the start, if that is more than ahead from now
+    ns += pStart->tv_nsec;
+    until.tv_sec  = pStart->tv_sec + (time_t)( ns / 1000000000u );
+    until.tv_nsec = (long)( ns % 1000000000u );
+    clock_gettime( CLOCK_MONOTONIC, &now );
+    if ( (int64_t)( until.tv_sec - now.tv_sec ) * 1000000000 + ( until.tv_nsec - now.tv_nsec ) <= (int64_t)ahead )
+    {
+        return;
+    }
+    while ( 0 != clock_nanosleep( CLOCK_MONOTONIC, TIMER_ABSTIME, &until, NULL ) )
+    {
+        // interrupted, sleep on
+    }
+}
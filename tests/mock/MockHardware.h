@@ -0,0 +1,152 @@
+//
+// Copyright(C) 2023 Husqvarna AB
+//
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU General Public License
+// as published by the Free Software Foundation; either version 2
+// of the License, or (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+
+/**
+ ******************************************************************************
+ * @file      MockHardware.h
+ *
+ * @copyright Copyright (c) Husqvarna AB
+ *
+ * @brief     Host stand-ins for the hardware under the port: the DMA2D,
+ *            simulated by a thread behind its registers, the LTDC frame
+ *            buffer and its refresh to the panel, and the interrupts
+ ******************************************************************************
+ */
+#ifndef MOCK_HARDWARE_H
+#define MOCK_HARDWARE_H
+
+/*
+ ------------------------------------------------------------------------------
+    Include files
+ ------------------------------------------------------------------------------
+ */
+#include <RoboticTypes.h>
+#include <stm32_hal.h>
+
+/*
+ ------------------------------------------------------------------------------
+    Type definitions
+ ------------------------------------------------------------------------------
+ */
+/* What the DMA2D did, and what it saw done wrong */
+typedef struct
+{
+    uint32_t transfers;    /* transfers started, fills and failed ones included */
+    uint32_t fills;        /* R2M transfers */
+    uint32_t clutLoads;    /* CLUTs loaded */
+    uint32_t configErrors; /* transfers started with a configuration the port never uses */
+    uint32_t busyWrites;   /* transfers whose registers were written while they ran */
+    uint32_t sourceWrites; /* transfers whose source was written while they ran */
+} tMockDma2dStats;
+
+/* What the LTDC refreshed */
+typedef struct
+{
+    uint32_t refreshes;  /* refreshes of the panel since start-up */
+    uint32_t rowsBehind; /* rows the DMA2D wrote after the LTDC scanned them in that refresh, tearing */
+} tMockLcdStats;
+
+/*
+ ------------------------------------------------------------------------------
+    Interface functions
+ ------------------------------------------------------------------------------
+ */
+/* The LTDC frame buffer, ltdc_frame_buffer after ILCD_Init() */
+extern uint16_t mockPanel[ IMAGE_HEIGHT * IMAGE_WIDTH ];
+
+/**
+ ******************************************************************************
+ * @brief   Gets what the DMA2D did since start-up
+ ******************************************************************************
+ */
+void MockDma2d_GetStats( tMockDma2dStats* pStats );
+
+/**
+ ******************************************************************************
+ * @brief   Holds transfers, a started transfer waits to run until released
+ ******************************************************************************
+ */
+void MockDma2d_Hold( bool hold );
+
+/**
+ ******************************************************************************
+ * @brief   Makes the next transfer fail with a transfer error
+ ******************************************************************************
+ */
+void MockDma2d_FailNext( void );
+
+/**
+ ******************************************************************************
+ * @brief   Sets how long a transfer takes, 0 to run transfers at host speed
+ * @param   ns  nanoseconds per output pixel
+ ******************************************************************************
+ */
+void MockDma2d_SetPixelTime( uint32_t ns );
+
+/**
+ ******************************************************************************
+ * @brief   Enters and leaves an interrupt, which waits while the application
+ *          has interrupts disabled, see IInterrupt_GlobalDisable()
+ ******************************************************************************
+ */
+void MockInterrupt_Enter( void );
+void MockInterrupt_Exit( void );
+
+/**
+ ******************************************************************************
+ * @brief   Gets if the backlight was switched on, see ILCD_Backlight()
+ ******************************************************************************
+ */
+bool MockLcd_GetBacklight( void );
+
+/**
+ ******************************************************************************
+ * @brief   Starts the LTDC refreshing the panel, or stops it
+ * @param   us  microseconds a refresh takes, 0 to stop
+ ******************************************************************************
+ */
+void MockLcd_Refresh( uint32_t us );
+
+/**
+ ******************************************************************************
+ * @brief   Enables the line event at the start of each vertical blanking of a
+ *          refresh, off at start-up
+ ******************************************************************************
+ */
+void MockLcd_EnableVerticalBlank( bool enable );
+
+/**
+ ******************************************************************************
+ * @brief   Raises the line event at the start of a vertical blanking, as the
+ *          refresh does, for a test that steps the frames itself
+ ******************************************************************************
+ */
+void MockLcd_VerticalBlank( void );
+
+/**
+ ******************************************************************************
+ * @brief   Tells the LTDC that the DMA2D wrote a row, called by the DMA2D
+ * @param   address  the start of the row
+ ******************************************************************************
+ */
+void MockLcd_RowWritten( uint32_t address );
+
+/**
+ ******************************************************************************
+ * @brief   Gets what the LTDC refreshed since start-up
+ ******************************************************************************
+ */
+void MockLcd_GetStats( tMockLcdStats* pStats );
+
+#endif /* MOCK_HARDWARE_H */
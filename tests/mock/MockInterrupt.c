@@ -0,0 +1,109 @@
+//
+// Copyright(C) 2023 Husqvarna AB
+//
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU General Public License
+// as published by the Free Software Foundation; either version 2
+// of the License, or (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+
+/**
+ ******************************************************************************
+ * @file      MockInterrupt.c
+ *
+ * @copyright Copyright (c) Husqvarna AB
+ *
+ * @brief     Interrupts and watchdog for host tests. Disabling interrupts takes
+ *            a lock that the simulated interrupts take as well, and nests as
+ *            Interrupt.c does
+ ******************************************************************************
+ */
+/*
+ ------------------------------------------------------------------------------
+ Include files
+ ------------------------------------------------------------------------------
+ */
+#define _GNU_SOURCE // recursive mutex initializer
+
+#include "IInterrupt.h"
+#include "IWatchdog.h"
+#include "MockHardware.h"
+
+#include <pthread.h>
+
+/*
+ ------------------------------------------------------------------------------
+ Private data
+ ------------------------------------------------------------------------------
+ */
+static pthread_mutex_t   mockInterruptLock = PTHREAD_RECURSIVE_MUTEX_INITIALIZER_NP;
+static __thread uint32_t mockDisableCount  = 0;
+static __thread bool     mockInIsr         = false;
+
+/*
+ ------------------------------------------------------------------------------
+ Implementation of interface functions
+ ------------------------------------------------------------------------------
+ */
+void IInterrupt_Init( void )
+{
+}
+
+void IInterrupt_Start( void )
+{
+}
+
+void IInterrupt_GlobalDisable( void )
+{
+    pthread_mutex_lock( &mockInterruptLock );
+    mockDisableCount++;
+}
+
+void IInterrupt_GlobalEnable( void )
+{
+    mockDisableCount--;
+    pthread_mutex_unlock( &mockInterruptLock );
+}
+
+uint8 IInterrupt_GetStatus( void )
+{
+    return 0 == mockDisableCount ? 1 : 0;
+}
+
+bool IInterrupt_InIsr( void )
+{
+    return mockInIsr;
+}
+
+void MockInterrupt_Enter( void )
+{
+    IInterrupt_GlobalDisable();
+    mockInIsr = true;
+}
+
+void MockInterrupt_Exit( void )
+{
+    mockInIsr = false;
+    IInterrupt_GlobalEnable();
+}
+
+void IWatchdog_Init( void )
+{
+}
+
+void IWatchdog_Start( void )
+{
+}
+
+void IWatchdog_Activate( void )
+{
+}
+
+void IWatchdog_Refresh( void )
+{
+}
@@ -0,0 +1,227 @@
+//
+// Copyright(C) 2023 Husqvarna AB
+//
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU General Public License
+// as published by the Free Software Foundation; either version 2
+// of the License, or (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+
+/**
+ ******************************************************************************
+ * @file      MockLcd.c
+ *
+ * @copyright Copyright (c) Husqvarna AB
+ *
+ * @brief     LCD for host tests, the LTDC frame buffer the DMA2D draws into,
+ *            refreshed to the panel by a thread that scans it line by line
+ *            and raises the line event at the start of each vertical
+ *            blanking, as LCD_VerticalBlank() does on the target. The rows
+ *            the DMA2D writes behind the scan, where the panel tears, are
+ *            counted
+ ******************************************************************************
+ */
+/*
+ ------------------------------------------------------------------------------
+ Include files
+ ------------------------------------------------------------------------------
+ */
+#include "ILCD.h"
+#include "MockHardware.h"
+
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+/*
+ ------------------------------------------------------------------------------
+ Local defines
+ ------------------------------------------------------------------------------
+ */
+#define MOCK_LCD_BLANK_LINES ( 8 )                                   // lines of vertical blanking before the active area
+#define MOCK_LCD_LINES       ( MOCK_LCD_BLANK_LINES + IMAGE_HEIGHT ) // lines of a refresh
+#define MOCK_LCD_POLL_NS     ( 1000000 )                             // how often the stopped LTDC looks to start
+
+/*
+ ------------------------------------------------------------------------------
+ Private data
+ ------------------------------------------------------------------------------
+ */
+uint16_t mockPanel[ IMAGE_HEIGHT * IMAGE_WIDTH ];
+uint32_t ltdc_frame_buffer;
+
+static bool           mockBacklight             = false;
+static tEventCallback mockVerticalBlankCallback = NULL;
+static uint32_t       mockVerticalBlanks        = 0;
+
+static volatile uint32_t mockRefreshTime  = 0;     // ns a refresh takes, 0 while the LTDC is stopped
+static volatile bool     mockLineEvent    = false; // the line event is enabled
+static volatile int64_t  mockRefreshStart = 0;     // ns, the start of the vertical blanking of the current refresh
+static tMockLcdStats     mockLcdStats;
+
+/*
+ ------------------------------------------------------------------------------
+ Private function prototypes
+ ------------------------------------------------------------------------------
+ */
+static void*   MockLcd_Run( void* pArg );
+static int64_t MockLcd_Now( void );
+
+/*
+ ------------------------------------------------------------------------------
+ Implementation of interface functions
+ ------------------------------------------------------------------------------
+ */
+void ILCD_Init( void )
+{
+    static bool started = false;
+    pthread_t   thread;
+
+    // the DMA2D addresses are 32 bits, as on the target
+    if ( (uintptr_t)mockPanel > UINT32_MAX )
+    {
+        printf( "The LCD frame buffer is above 4 GB, link with -no-pie\n" );
+        exit( 1 );
+    }
+    ltdc_frame_buffer = (uint32_t)(uintptr_t)mockPanel;
+
+    // the LTDC thread, started before MX_DMA2D_Init() lowers the priority of the application
+    if ( !started )
+    {
+        started = true;
+        pthread_create( &thread, NULL, &MockLcd_Run, NULL );
+        pthread_detach( thread );
+    }
+}
+
+void ILCD_Start( void )
+{
+}
+
+void ILCD_Backlight( bool backlight )
+{
+    mockBacklight = backlight;
+}
+
+void ILCD_SetRotation( LcdRotation rotation )
+{
+    (void)rotation;
+}
+
+void ILCD_SetVerticalBlankCallback( tEventCallback eventCallback )
+{
+    mockVerticalBlankCallback = eventCallback;
+}
+
+bool MockLcd_GetBacklight( void )
+{
+    return mockBacklight;
+}
+
+void MockLcd_Refresh( uint32_t us )
+{
+    mockRefreshTime = us * 1000;
+}
+
+void MockLcd_EnableVerticalBlank( bool enable )
+{
+    mockLineEvent = enable;
+}
+
+void MockLcd_VerticalBlank( void )
+{
+    MockInterrupt_Enter();
+    mockVerticalBlanks++;
+    if ( NULL != mockVerticalBlankCallback )
+    {
+        tEvent event;
+        event.id   = ILCD_EVENT_VERTICAL_BLANK;
+        event.data = mockVerticalBlanks;
+        mockVerticalBlankCallback( event );
+    }
+    MockInterrupt_Exit();
+}
+
+void MockLcd_RowWritten( uint32_t address )
+{
+    const uint64_t refresh = mockRefreshTime;
+
+    if ( ( 0 == refresh ) || ( address < ltdc_frame_buffer ) )
+    {
+        return;
+    }
+    const uint32_t row = ( address - ltdc_frame_buffer ) / ( IMAGE_WIDTH * FRAMEBUFFER_BPP );
+    if ( IMAGE_HEIGHT <= row )
+    {
+        return;
+    }
+
+    // the row the LTDC scans, negative in the vertical blanking
+    const int64_t scan = ( MockLcd_Now() - mockRefreshStart ) * MOCK_LCD_LINES / (int64_t)refresh - MOCK_LCD_BLANK_LINES;
+    if ( (int64_t)row < scan )
+    {
+        __atomic_fetch_add( &mockLcdStats.rowsBehind, 1, __ATOMIC_SEQ_CST );
+    }
+}
+
+void MockLcd_GetStats( tMockLcdStats* pStats )
+{
+    __atomic_thread_fence( __ATOMIC_SEQ_CST );
+    *pStats = mockLcdStats;
+}
+
+/*
+ -------------------------------------------------------------------------------
+ Implementation of private functions
+ -------------------------------------------------------------------------------
+ */
+static void* MockLcd_Run( void* pArg )
+{
+    struct timespec next;
+
+    (void)pArg;
+    for ( ;; )
+    {
+        const uint32_t refresh = mockRefreshTime;
+
+        // host sleeps may wake late, a refresh starts when the thread wakes, so the scan and its line event agree
+        clock_gettime( CLOCK_MONOTONIC, &next );
+        if ( 0 == refresh )
+        {
+            next.tv_nsec += MOCK_LCD_POLL_NS;
+        }
+        else
+        {
+            // a refresh starts with the vertical blanking, then scans the frame buffer a line at a time
+            mockRefreshStart = (int64_t)next.tv_sec * 1000000000 + next.tv_nsec;
+            mockLcdStats.refreshes++;
+            if ( mockLineEvent )
+            {
+                MockLcd_VerticalBlank();
+            }
+            next.tv_nsec += refresh;
+        }
+        next.tv_sec += next.tv_nsec / 1000000000;
+        next.tv_nsec %= 1000000000;
+
+        while ( 0 != clock_nanosleep( CLOCK_MONOTONIC, TIMER_ABSTIME, &next, NULL ) )
+        {
+            // interrupted, sleep on
+        }
+    }
+    return NULL;
+}
+
+static int64_t MockLcd_Now( void )
+{
+    struct timespec now;
+
+    clock_gettime( CLOCK_MONOTONIC, &now );
+    return (int64_t)now.tv_sec * 1000000000 + now.tv_nsec;
+}
@@ -0,0 +1,155 @@
+//
+// Copyright(C) 2023 Husqvarna AB
+//
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU General Public License
+// as published by the Free Software Foundation; either version 2
+// of the License, or (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+
+/**
+ ******************************************************************************
+ * @file      stm32_hal.h
+ *
+ * @copyright Copyright (c) Husqvarna AB
+ *
+ * @brief     Host stand-in for the CubeMX HAL header, the parts of the DMA2D
+ *            and LTDC the port uses. The registers and bits are those of
+ *            stm32f469xx.h and stm32f4xx_hal_dma2d.h, the DMA2D behind them
+ *            is simulated by MockDma2d.c
+ ******************************************************************************
+ */
+#ifndef __STM32_HAL_H
+#define __STM32_HAL_H
+
+#include <stdint.h>
+
+/*
+ ------------------------------------------------------------------------------
+    CMSIS
+ ------------------------------------------------------------------------------
+ */
+#define __IO volatile
+
+#define WRITE_REG( REG, VAL )                   ( ( REG ) = ( VAL ) )
+#define READ_REG( REG )                         ( ( REG ) )
+#define MODIFY_REG( REG, CLEARMASK, SETMASK )   WRITE_REG( ( REG ), ( ( ( READ_REG( REG ) ) & ( ~( CLEARMASK ) ) ) | ( SETMASK ) ) )
+
+typedef struct
+{
+    __IO uint32_t CR;
+    __IO uint32_t ISR;
+    __IO uint32_t IFCR;
+    __IO uint32_t FGMAR;
+    __IO uint32_t FGOR;
+    __IO uint32_t BGMAR;
+    __IO uint32_t BGOR;
+    __IO uint32_t FGPFCCR;
+    __IO uint32_t FGCOLR;
+    __IO uint32_t BGPFCCR;
+    __IO uint32_t BGCOLR;
+    __IO uint32_t FGCMAR;
+    __IO uint32_t BGCMAR;
+    __IO uint32_t OPFCCR;
+    __IO uint32_t OCOLR;
+    __IO uint32_t OMAR;
+    __IO uint32_t OOR;
+    __IO uint32_t NLR;
+    __IO uint32_t LWR;
+    __IO uint32_t AMTCR;
+    uint32_t      RESERVED[ 236 ];
+    __IO uint32_t FGCLUT[ 256 ];
+    __IO uint32_t BGCLUT[ 256 ];
+} DMA2D_TypeDef;
+
+extern DMA2D_TypeDef mockDma2d;
+#define DMA2D ( &mockDma2d )
+
+#define DMA2D_CR_START_Pos      ( 0U )
+#define DMA2D_CR_START          ( 0x1UL << DMA2D_CR_START_Pos )
+#define DMA2D_CR_TEIE           ( 0x1UL << 8U )
+#define DMA2D_CR_TCIE           ( 0x1UL << 9U )
+#define DMA2D_CR_CEIE           ( 0x1UL << 13U )
+#define DMA2D_CR_MODE_Pos       ( 16U )
+#define DMA2D_CR_MODE           ( 0x3UL << DMA2D_CR_MODE_Pos )
+#define DMA2D_CR_MODE_0         ( 0x1UL << DMA2D_CR_MODE_Pos )
+#define DMA2D_CR_MODE_1         ( 0x2UL << DMA2D_CR_MODE_Pos )
+
+#define DMA2D_ISR_TEIF          ( 0x1UL << 0U )
+#define DMA2D_ISR_TCIF          ( 0x1UL << 1U )
+#define DMA2D_ISR_CTCIF         ( 0x1UL << 4U )
+#define DMA2D_ISR_CEIF          ( 0x1UL << 5U )
+
+#define DMA2D_IFCR_CTEIF        ( 0x1UL << 0U )
+#define DMA2D_IFCR_CTCIF        ( 0x1UL << 1U )
+#define DMA2D_IFCR_CCTCIF       ( 0x1UL << 4U )
+#define DMA2D_IFCR_CCEIF        ( 0x1UL << 5U )
+
+#define DMA2D_FGOR_LO           ( 0x3FFFUL )
+
+#define DMA2D_FGPFCCR_CM_Pos    ( 0U )
+#define DMA2D_FGPFCCR_CM        ( 0xFUL << DMA2D_FGPFCCR_CM_Pos )
+#define DMA2D_FGPFCCR_CCM_Pos   ( 4U )
+#define DMA2D_FGPFCCR_CCM       ( 0x1UL << DMA2D_FGPFCCR_CCM_Pos )
+#define DMA2D_FGPFCCR_START     ( 0x1UL << 5U )
+#define DMA2D_FGPFCCR_CS_Pos    ( 8U )
+#define DMA2D_FGPFCCR_CS        ( 0xFFUL << DMA2D_FGPFCCR_CS_Pos )
+
+#define DMA2D_OPFCCR_CM         ( 0x7UL )
+
+#define DMA2D_OOR_LO            ( 0x3FFFUL )
+
+#define DMA2D_NLR_NL            ( 0xFFFFUL )
+#define DMA2D_NLR_PL_Pos        ( 16U )
+#define DMA2D_NLR_PL            ( 0x3FFFUL << DMA2D_NLR_PL_Pos )
+
+/*
+ ------------------------------------------------------------------------------
+    HAL
+ ------------------------------------------------------------------------------
+ */
+#define DMA2D_M2M               0x00000000U
+#define DMA2D_M2M_PFC           DMA2D_CR_MODE_0
+#define DMA2D_M2M_BLEND         DMA2D_CR_MODE_1
+#define DMA2D_R2M               DMA2D_CR_MODE
+
+#define DMA2D_OUTPUT_RGB565     0x00000002U
+
+#define DMA2D_INPUT_ARGB8888    0x00000000U
+#define DMA2D_INPUT_RGB565      0x00000002U
+#define DMA2D_INPUT_L8          0x00000005U
+
+#define DMA2D_CCM_ARGB8888      0x00000000U
+
+typedef struct __DMA2D_HandleTypeDef
+{
+    DMA2D_TypeDef* Instance;
+    void ( *XferCpltCallback )( struct __DMA2D_HandleTypeDef* hdma2d );
+    void ( *XferErrorCallback )( struct __DMA2D_HandleTypeDef* hdma2d );
+} DMA2D_HandleTypeDef;
+
+void HAL_DMA2D_IRQHandler( DMA2D_HandleTypeDef* hdma2d );
+
+/*
+ ------------------------------------------------------------------------------
+    CubeMX
+ ------------------------------------------------------------------------------
+ */
+// main.h
+#define FRAMEBUFFER_BPP 2
+#define IMAGE_WIDTH     240
+#define IMAGE_HEIGHT    320
+
+// dma2d.h
+extern DMA2D_HandleTypeDef hdma2d;
+void MX_DMA2D_Init( void );
+
+// ltdc.h
+extern uint32_t ltdc_frame_buffer;
+
+#endif /* __STM32_HAL_H */
@@ -0,0 +1,469 @@
+//
+// Copyright(C) 2023 Husqvarna AB
+//
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU General Public License
+// as published by the Free Software Foundation; either version 2
+// of the License, or (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// DESCRIPTION:
+//	Host test of the DMA2D queue of Draw.c, against the register
+//	level DMA2D of mock/MockDma2d.c: what lands in the LTDC frame
+//	buffer, the callbacks, the queue limit, transfer errors, and
+//	that the DMA2D is only reconfigured, and the CLUT only loaded,
+//	when an operation needs it.
+//
+
+#include <malloc.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "IDraw.h"
+#include "IInterrupt.h"
+#include "MockHardware.h"
+
+
+static int	errors;
+static int	checks;
+
+#define CHECK(cond, ...)						\
+    do {								\
+	checks++;							\
+	if (!(cond) && errors++ < 20)					\
+	{								\
+	    printf ("%s:%d: ", __FILE__, __LINE__);			\
+	    printf (__VA_ARGS__);					\
+	    printf ("\n");						\
+	}								\
+    } while (0)
+
+
+// The DOOM screen, as mylcd.c hands it over: 320 rows of 200 pixels,
+//  drawn in bands of rows that land on the panel rotated by 270 degrees
+#define SCREENWIDTH	200
+#define SCREENHEIGHT	320
+#define BANDROWS	80
+#define BANDS		(SCREENHEIGHT / BANDROWS)
+#define XOFFSET		20
+
+static uint16_t	screen[SCREENHEIGHT * SCREENWIDTH];
+static uint8_t	indexed[SCREENHEIGHT * SCREENWIDTH];
+static uint32_t	clutA[256];
+static uint32_t	clutB[256];
+
+
+static uint16_t RGB565 (uint32_t argb)
+{
+    return ((argb >> 19) & 0x1f) << 11 | ((argb >> 10) & 0x3f) << 5 | ((argb >> 3) & 0x1f);
+}
+
+
+//
+// Callbacks, from the DMA2D interrupt
+//
+
+#define MAXEVENTS	64
+
+static volatile int	numevents;
+static uint32_t		events[MAXEVENTS];
+static int		eventtags[MAXEVENTS];
+static int		outsideisr;
+
+static void Record (int tag, tEvent event)
+{
+    if (!IInterrupt_InIsr ())
+	outsideisr++;
+    if (numevents < MAXEVENTS)
+    {
+	events[numevents] = event.id;
+	eventtags[numevents] = tag;
+    }
+    numevents++;
+}
+
+static void Done0 (tEvent event) { Record (0, event); }
+static void Done1 (tEvent event) { Record (1, event); }
+static void Done2 (tEvent event) { Record (2, event); }
+static void Done3 (tEvent event) { Record (3, event); }
+
+static tEventCallback	donecallbacks[4] = { Done0, Done1, Done2, Done3 };
+
+
+// waits for the DMA2D, and for the interrupt to return from the last callback
+static void Sync (void)
+{
+    IDraw_Sync ();
+    IInterrupt_GlobalDisable ();
+    IInterrupt_GlobalEnable ();
+}
+
+// draws a band of rows of the screen, as lcd_start_transfer() does
+static bool DrawBand (int band, bool l8, const uint32_t* clut, tEventCallback callback)
+{
+    tIDraw_ControlBlock	cb;
+
+    cb.header.xSize = BANDROWS;
+    cb.header.ySize = SCREENWIDTH;
+    if (l8)
+    {
+	cb.header.totalSize = BANDROWS * SCREENWIDTH;
+	cb.header.format = IDRAW_FORMAT_L8;
+	cb.dataL8.pData = indexed + band * BANDROWS * SCREENWIDTH;
+	cb.dataL8.pClut = clut;
+	cb.dataL8.pitch = BANDROWS;
+    }
+    else
+    {
+	cb.header.totalSize = BANDROWS * SCREENWIDTH * 2;
+	cb.header.format = IDRAW_FORMAT_RGB565;
+	cb.dataRGB565.pData = screen + band * BANDROWS * SCREENWIDTH;
+	cb.dataRGB565.pitch = BANDROWS;
+    }
+
+    return IDraw_Draw (&cb, SCREENHEIGHT - (band + 1) * BANDROWS, XOFFSET, callback);
+}
+
+// the panel shows the screen, and the fill color beside it
+static int CheckPanel (bool l8, const uint32_t* clut, uint16_t fill)
+{
+    int		bad = 0;
+    int		x;
+    int		y;
+    uint16_t	want;
+
+    for (y = 0; y < IMAGE_HEIGHT; y++)
+    {
+	for (x = 0; x < IMAGE_WIDTH; x++)
+	{
+	    if (x < XOFFSET || x >= XOFFSET + SCREENWIDTH)
+		want = fill;
+	    else if (l8)
+		want = RGB565 (clut[indexed[y * SCREENWIDTH + x - XOFFSET]]);
+	    else
+		want = screen[y * SCREENWIDTH + x - XOFFSET];
+
+	    if (mockPanel[y * IMAGE_WIDTH + x] != want && bad++ < 3)
+		printf ("panel (%d, %d) = %04x, not %04x\n",
+			x, y, mockPanel[y * IMAGE_WIDTH + x], want);
+	}
+    }
+
+    return bad;
+}
+
+
+static uint32_t	randstate = 0x2545f491;
+
+static uint32_t Random32 (void)
+{
+    // xorshift32
+    randstate ^= randstate << 13;
+    randstate ^= randstate >> 17;
+    randstate ^= randstate << 5;
+    return randstate;
+}
+
+static void NewScreens (void)
+{
+    int		i;
+
+    for (i = 0; i < SCREENHEIGHT * SCREENWIDTH; i++)
+    {
+	screen[i] = (uint16_t) Random32 ();
+	indexed[i] = (uint8_t) Random32 ();
+    }
+}
+
+
+//
+// Tests
+//
+
+static void TestStart (void)
+{
+    memset (mockPanel, 0x55, sizeof (mockPanel));
+
+    IDraw_Init ();
+    IDraw_Start ();
+
+    // blanked before the backlight goes on
+    CHECK (MockLcd_GetBacklight (), "backlight off");
+    CHECK (mockPanel[0] == 0 && mockPanel[IMAGE_HEIGHT * IMAGE_WIDTH - 1] == 0,
+	   "panel not blanked");
+}
+
+static void TestFill (void)
+{
+    const uint32_t	color = 0xff12a4f8;
+    int			i;
+    int			bad = 0;
+
+    CHECK (IDraw_FillDisplay (color), "fill not queued");
+
+    for (i = 0; i < IMAGE_HEIGHT * IMAGE_WIDTH; i++)
+	if (mockPanel[i] != RGB565 (color))
+	    bad++;
+
+    CHECK (bad == 0, "%d pixels not filled with %04x", bad, RGB565 (color));
+}
+
+static void TestBands (void)
+{
+    int		band;
+
+    NewScreens ();
+    IDraw_FillDisplay (0xff000000);
+
+    numevents = 0;
+    for (band = 0; band < BANDS; band++)
+	CHECK (DrawBand (band, false, NULL, donecallbacks[band]), "band %d not queued", band);
+    Sync ();
+
+    CHECK (numevents == BANDS, "%d callbacks for %d bands", numevents, BANDS);
+    for (band = 0; band < BANDS && band < numevents; band++)
+	CHECK (eventtags[band] == band && events[band] == IDRAW_EVENT_DONE,
+	       "callback %d is band %d, event %x", band, eventtags[band], events[band]);
+    CHECK (outsideisr == 0, "%d callbacks outside the interrupt", outsideisr);
+
+    CHECK (CheckPanel (false, NULL, 0) == 0, "RGB565 bands");
+}
+
+static void TestClut (void)
+{
+    tMockDma2dStats	before;
+    tMockDma2dStats	after;
+    int			band;
+    int			i;
+
+    for (i = 0; i < 256; i++)
+    {
+	clutA[i] = 0xff000000 | Random32 ();
+	clutB[i] = 0xff000000 | Random32 ();
+    }
+
+    // a CLUT is loaded once for all bands
+    MockDma2d_GetStats (&before);
+    for (band = 0; band < BANDS; band++)
+	DrawBand (band, true, clutA, NULL);
+    Sync ();
+    MockDma2d_GetStats (&after);
+    CHECK (after.clutLoads - before.clutLoads == 1,
+	   "%u CLUT loads for one CLUT", after.clutLoads - before.clutLoads);
+    CHECK (CheckPanel (true, clutA, 0) == 0, "L8 bands, CLUT A");
+
+    // another CLUT is loaded, and kept over RGB565 copies and fills
+    for (band = 0; band < BANDS; band++)
+	DrawBand (band, true, clutB, NULL);
+    DrawBand (0, false, NULL, NULL);
+    IDraw_Fill (0xff000000, NULL);
+    Sync ();
+    for (band = 0; band < BANDS; band++)
+	DrawBand (band, true, clutB, NULL);
+    Sync ();
+    MockDma2d_GetStats (&before);
+    CHECK (before.clutLoads - after.clutLoads == 1,
+	   "%u CLUT loads for one new CLUT", before.clutLoads - after.clutLoads);
+    CHECK (CheckPanel (true, clutB, 0) == 0, "L8 bands, CLUT B");
+}
+
+// an image that lands above and right of the panel, partly
+static void DrawClipped (void)
+{
+    tIDraw_ControlBlock	cb;
+
+    cb.header.xSize = 80;
+    cb.header.ySize = 200;
+    cb.header.totalSize = 80 * 200 * 2;
+    cb.header.format = IDRAW_FORMAT_RGB565;
+    cb.dataRGB565.pData = screen;
+    cb.dataRGB565.pitch = 80;
+    CHECK (IDraw_Draw (&cb, 300, 100, NULL), "clipped image not queued");
+    Sync ();
+}
+
+static void TestConfig (void)
+{
+    // bits above the 14-bit offsets, that the DMA2D ignores
+    const uint32_t	marker = 1u << 30;
+    int			band;
+
+    for (band = 0; band < BANDS; band++)
+	DrawBand (band, false, NULL, NULL);
+    Sync ();
+
+    // operations like the last one leave the offsets alone
+    DMA2D->OOR |= marker;
+    DMA2D->FGOR |= marker;
+    for (band = 0; band < BANDS; band++)
+	DrawBand (band, false, NULL, NULL);
+    Sync ();
+    CHECK ((DMA2D->OOR & marker) && (DMA2D->FGOR & marker), "offsets written again");
+    CHECK (CheckPanel (false, NULL, 0) == 0, "RGB565 bands, offsets kept");
+
+    // a fill writes the output offset, and leaves the input offset
+    IDraw_FillDisplay (0xff000000);
+    CHECK (!(DMA2D->OOR & marker), "output offset not written for a fill");
+    CHECK (DMA2D->FGOR & marker, "input offset written for a fill");
+
+    // and the input offset when it changes, for a clipped image
+    DrawClipped ();
+    CHECK (!(DMA2D->FGOR & marker), "input offset not written for a clipped image");
+
+    IDraw_FillDisplay (0xff000000);
+    for (band = 0; band < BANDS; band++)
+	DrawBand (band, false, NULL, NULL);
+    Sync ();
+    CHECK (CheckPanel (false, NULL, 0) == 0, "RGB565 bands after a clipped image");
+}
+
+static void TestClip (void)
+{
+    tIDraw_ControlBlock	cb;
+    int			bad = 0;
+    int			x;
+    int			y;
+    uint16_t		want;
+
+    // the panel rows above the image are cut off, and the columns right of the panel
+    IDraw_FillDisplay (0xff000000);
+    DrawClipped ();
+
+    for (y = 0; y < IMAGE_HEIGHT; y++)
+    {
+	for (x = 0; x < IMAGE_WIDTH; x++)
+	{
+	    want = 0;
+	    if (y < 20 && x >= 100)
+		want = screen[(y + 60) * 200 + x - 100];
+	    if (mockPanel[y * IMAGE_WIDTH + x] != want)
+		bad++;
+	}
+    }
+    CHECK (bad == 0, "%d pixels of the clipped image", bad);
+    IDraw_FillDisplay (0xff000000);
+
+    // nothing on the panel
+    cb.header.xSize = 80;
+    cb.header.ySize = 200;
+    cb.header.totalSize = 80 * 200 * 2;
+    cb.header.format = IDRAW_FORMAT_RGB565;
+    cb.dataRGB565.pData = screen;
+    cb.dataRGB565.pitch = 80;
+    CHECK (!IDraw_Draw (&cb, 0, 240, NULL), "image right of the panel queued");
+    CHECK (!IDraw_Draw (&cb, 400, 0, NULL), "image above the panel queued");
+
+    // nothing to draw
+    cb.header.totalSize = 0;
+    numevents = 0;
+    CHECK (IDraw_Draw (&cb, 0, 0, Done0), "empty image not done");
+    CHECK (numevents == 1 && events[0] == IDRAW_EVENT_DONE, "empty image not done");
+}
+
+static void TestQueue (void)
+{
+    int		i;
+    int		queued = 0;
+
+    // operations queue up behind a transfer, and calls return straight away
+    numevents = 0;
+    MockDma2d_Hold (true);
+    for (i = 0; i < 9; i++)
+	if (DrawBand (i % BANDS, false, NULL, donecallbacks[i % BANDS]))
+	    queued++;
+    CHECK (queued == 8, "%d of 9 operations queued, not 8", queued);
+    CHECK (!IDraw_Fill (0xff000000, NULL), "fill queued to a full queue");
+    CHECK (numevents == 0, "%d operations done while held", numevents);
+
+    MockDma2d_Hold (false);
+    Sync ();
+    CHECK (numevents == 8, "%d of 8 operations done", numevents);
+    for (i = 0; i < 8 && i < numevents; i++)
+	CHECK (eventtags[i] == i % BANDS, "callback %d is for %d", i, eventtags[i]);
+    CHECK (CheckPanel (false, NULL, 0) == 0, "RGB565 bands, queued");
+}
+
+// each band, when done, queues the next from the interrupt
+static void Chain (tEvent event)
+{
+    int		band = numevents % BANDS;
+
+    Record (band, event);
+    if (numevents < 4 * BANDS)
+	CHECK (DrawBand ((band + 1) % BANDS, false, NULL, Chain), "band queued from the interrupt");
+}
+
+static void TestChain (void)
+{
+    tEvent	event;
+
+    NewScreens ();
+    numevents = 0;
+    event.id = IDRAW_EVENT_DONE;
+    MockInterrupt_Enter ();
+    Chain (event);
+    MockInterrupt_Exit ();
+    Sync ();
+
+    CHECK (numevents == 4 * BANDS, "%d of %d chained operations", numevents, 4 * BANDS);
+    CHECK (CheckPanel (false, NULL, 0) == 0, "RGB565 bands, chained");
+}
+
+static void TestError (void)
+{
+    int		band;
+
+    NewScreens ();
+    numevents = 0;
+
+    // a failed transfer is reported, and the next one goes on
+    MockDma2d_Hold (true);
+    MockDma2d_FailNext ();
+    for (band = 0; band < BANDS; band++)
+	DrawBand (band, false, NULL, donecallbacks[band]);
+    MockDma2d_Hold (false);
+    Sync ();
+
+    CHECK (numevents == BANDS, "%d callbacks for %d bands", numevents, BANDS);
+    CHECK (events[0] == IDRAW_EVENT_FAILED, "failed transfer reported as %x", events[0]);
+    for (band = 1; band < BANDS && band < numevents; band++)
+	CHECK (events[band] == IDRAW_EVENT_DONE, "band %d reported as %x", band, events[band]);
+
+    // and is done right when drawn again
+    DrawBand (0, false, NULL, NULL);
+    Sync ();
+    CHECK (CheckPanel (false, NULL, 0) == 0, "RGB565 bands after an error");
+}
+
+
+int main (void)
+{
+    tMockDma2dStats	stats;
+
+    // mallocs below 4 GB, the DMA2D addresses are 32 bits
+    mallopt (M_MMAP_MAX, 0);
+
+    TestStart ();
+    TestFill ();
+    TestBands ();
+    TestClut ();
+    TestConfig ();
+    TestClip ();
+    TestQueue ();
+    TestChain ();
+    TestError ();
+
+    MockDma2d_GetStats (&stats);
+    CHECK (stats.configErrors == 0, "%u configuration errors", stats.configErrors);
+    CHECK (stats.busyWrites == 0, "%u transfers reconfigured while running", stats.busyWrites);
+    CHECK (stats.sourceWrites == 0, "%u transfers with their source written", stats.sourceWrites);
+
+    printf ("%d checks, %u transfers, %u CLUT loads: %d errors\n",
+	    checks, stats.transfers, stats.clutLoads, errors);
+
+    return errors != 0;
+}
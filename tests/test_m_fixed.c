@@ -0,0 +1,196 @@
+//
+// Copyright(C) 2023 Husqvarna AB
+//
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU General Public License
+// as published by the Free Software Foundation; either version 2
+// of the License, or (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// DESCRIPTION:
+//	Host test of FixedDiv and FixedMul, bit-exact against the
+//	64-bit C versions, clamp included.
+//	With -full, all 2^32 dividends are checked for the edge
+//	divisors and all 2^32 divisors for the edge dividends.
+//
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "m_fixed.h"
+
+
+static int	errors;
+static long long checks;
+static long long clamps;
+
+
+//
+// The original versions
+//
+
+static fixed_t RefFixedMul (fixed_t a, fixed_t b)
+{
+    return ((int64_t) a * (int64_t) b) >> FRACBITS;
+}
+
+static fixed_t RefFixedDiv (fixed_t a, fixed_t b)
+{
+    if ((abs(a) >> 14) >= abs(b))
+    {
+	return (a^b) < 0 ? INT_MIN : INT_MAX;
+    }
+    else
+    {
+	int64_t result;
+
+	result = ((int64_t) a << 16) / b;
+
+	return (fixed_t) result;
+    }
+}
+
+
+static uint32_t	randstate = 0x12345678;
+
+static uint32_t Random32 (void)
+{
+    // xorshift32
+    randstate ^= randstate << 13;
+    randstate ^= randstate >> 17;
+    randstate ^= randstate << 5;
+    return randstate;
+}
+
+// a random value of random bit length and sign
+static fixed_t RandomFixed (void)
+{
+    uint32_t	r = Random32 ();
+    fixed_t	v = (fixed_t) (Random32 () >> (r & 31));
+
+    return (r & 32) ? -v : v;
+}
+
+
+static void Check (fixed_t a, fixed_t b)
+{
+    fixed_t	got;
+    fixed_t	want;
+
+    checks++;
+
+    if (b != 0)
+    {
+	if ((abs(a) >> 14) >= abs(b))
+	    clamps++;
+
+	got = FixedDiv (a, b);
+	want = RefFixedDiv (a, b);
+
+	if (got != want && errors++ < 10)
+	    printf ("FixedDiv(%d, %d) = %d, not %d\n", a, b, got, want);
+    }
+
+    got = FixedMul (a, b);
+    want = RefFixedMul (a, b);
+
+    if (got != want && errors++ < 10)
+	printf ("FixedMul(%d, %d) = %d, not %d\n", a, b, got, want);
+}
+
+
+// values around each power of two, and the limits
+static fixed_t	edges[32 * 14 + 6];
+static int	numedges;
+
+static void InitEdges (void)
+{
+    int		i;
+    int		d;
+
+    edges[numedges++] = 0;
+    edges[numedges++] = 1;
+    edges[numedges++] = -1;
+    edges[numedges++] = INT_MAX;
+    edges[numedges++] = INT_MIN;
+    edges[numedges++] = INT_MIN + 1;
+
+    for (i = 1; i < 31; i++)
+    {
+	for (d = -3; d <= 3; d++)
+	{
+	    edges[numedges++] = (1 << i) + d;
+	    edges[numedges++] = -((1 << i) + d);
+	}
+    }
+}
+
+
+// divisors and dividends that take each path of FixedDiv
+static const fixed_t sweepvalues[16] =
+{
+    1, -1, 3, 0xffff, 0x10000, -0x10000, 0x10001, 0x12345,
+    0x7fff, 0x8000, -0x8001, 0x1234567, 0x40000000, -0x40000000,
+    INT_MAX, INT_MIN
+};
+
+
+int main (int argc, char** argv)
+{
+    int		full = argc > 1 && !strcmp (argv[1], "-full");
+    long long	randoms = full ? 2000000000LL : 20000000LL;
+    uint32_t	step = full ? 1 : 4099;
+    long long	n;
+    uint64_t	v;
+    int		i;
+    int		j;
+    fixed_t	b;
+
+    InitEdges ();
+
+    // every pair of edge values
+    for (i = 0; i < numedges; i++)
+	for (j = 0; j < numedges; j++)
+	    Check (edges[i], edges[j]);
+
+    // dividends at the clamp boundary, (abs(a) >> 14) == abs(b)
+    for (n = 0; n < 1000000; n++)
+    {
+	b = (fixed_t) (Random32 () >> 15);
+	v = ((uint64_t) b << 14) + (Random32 () & 0x7fff);
+	if (v > INT_MAX)
+	    continue;
+	Check ((fixed_t) v, b);
+	Check (-(fixed_t) v, b);
+	Check ((fixed_t) v - 0x4000, -b);
+	Check ((fixed_t) v, b + 1);
+    }
+
+    // sweeps over one operand for edge values of the other
+    for (i = 0; i < 16; i++)
+    {
+	for (v = 0; v <= UINT32_MAX; v += step)
+	{
+	    Check ((fixed_t) (uint32_t) v, sweepvalues[i]);
+	    Check (sweepvalues[i], (fixed_t) (uint32_t) v);
+	}
+    }
+
+    for (n = 0; n < randoms; n++)
+	Check (RandomFixed (), RandomFixed ());
+
+    printf ("%lld checks, %lld clamped: %d errors\n", checks, clamps, errors);
+
+    if (clamps == 0)
+    {
+	printf ("The clamp path was not taken\n");
+	return 1;
+    }
+
+    return errors != 0;
+}
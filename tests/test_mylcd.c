@@ -0,0 +1,465 @@
+//
+// Copyright(C) 2023 Husqvarna AB
+//
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU General Public License
+// as published by the Free Software Foundation; either version 2
+// of the License, or (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// DESCRIPTION:
+//	Host test of the LCD adapter, mylcd.c over Draw.c, against the
+//	register level DMA2D of mock/MockDma2d.c: the fences that keep
+//	a band from being drawn into while the DMA2D transfers it, and
+//	the ping-pong buffers that let the next frame be drawn while
+//	the last one is transferred, and the pacing of frames to the
+//	vertical blanking of the LTDC of mock/MockLcd.c.
+//	Built for several band counts (-DLCD_REFRESH_BANDS), each run
+//	also times frames through a model of the conversion and the
+//	DMA2D, for tuning the band count:
+//	    test_mylcd_<bands> [<conversion us> <transfer us>]
+//
+
+#include <malloc.h>
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "IDraw.h"
+#include "MockHardware.h"
+#include "mylcd.h"
+
+
+static int	errors;
+static int	checks;
+
+#define CHECK(cond, ...)						\
+    do {								\
+	checks++;							\
+	if (!(cond) && errors++ < 20)					\
+	{								\
+	    printf ("%s:%d: ", __FILE__, __LINE__);			\
+	    printf (__VA_ARGS__);					\
+	    printf ("\n");						\
+	}								\
+    } while (0)
+
+
+// the screen is centered on the panel, rotated
+#define XOFFSET		20
+#define BANDPIXELS	(LCD_MAX_X * LCD_BAND_ROWS)
+
+// time the DMA2D takes per pixel, a frame in a few milliseconds
+#define PIXELTIME	50
+
+// a refresh of the panel, 60 Hz
+#define REFRESHTIME	16667
+
+// the timing model, the time the CPU takes to convert a frame, spread
+//  over the bands, and the time the DMA2D takes to transfer it
+static int	converttime = 6000;
+static int	transfertime = 2500;
+
+// what the panel shows once the transfers are done, as in the screen buffer
+static uint16_t	shown[LCD_MAX_X * LCD_MAX_Y];
+
+
+static uint32_t	randstate = 0x6b43a9b5;
+
+static uint32_t Random32 (void)
+{
+    // xorshift32
+    randstate ^= randstate << 13;
+    randstate ^= randstate >> 17;
+    randstate ^= randstate << 5;
+    return randstate;
+}
+
+// draws a frame into a band of the screen buffer, as I_FinishUpdate does
+static void DrawBand (int band, uint32_t frame)
+{
+    uint16_t*	buffer = (uint16_t *) lcd_get_frame_buffer ();
+    int		i;
+
+    for (i = band * BANDPIXELS; i < (band + 1) * BANDPIXELS; i++)
+    {
+	buffer[i] = (uint16_t) ((frame * 0x9e3779b1u + i * 0x85ebca6bu) >> 16);
+	shown[i] = buffer[i];
+    }
+}
+
+static void DrawFrame (uint32_t frame)
+{
+    int		band;
+
+    for (band = 0; band < LCD_REFRESH_BANDS; band++)
+    {
+	lcd_sync_band (band);
+	DrawBand (band, frame);
+	lcd_refresh_band (band);
+    }
+    lcd_refresh_end ();
+}
+
+// the panel shows the screen, black beside it
+static int CheckPanel (void)
+{
+    int		bad = 0;
+    int		x;
+    int		y;
+    uint16_t	want;
+
+    lcd_sync ();
+
+    for (y = 0; y < IMAGE_HEIGHT; y++)
+    {
+	for (x = 0; x < IMAGE_WIDTH; x++)
+	{
+	    want = 0;
+	    if (x >= XOFFSET && x < XOFFSET + LCD_MAX_X)
+		want = shown[y * LCD_MAX_X + x - XOFFSET];
+
+	    if (mockPanel[y * IMAGE_WIDTH + x] != want && bad++ < 3)
+		printf ("panel (%d, %d) = %04x, not %04x\n",
+			x, y, mockPanel[y * IMAGE_WIDTH + x], want);
+	}
+    }
+
+    return bad;
+}
+
+
+static int64_t Microseconds (void)
+{
+    struct timespec	now;
+
+    clock_gettime (CLOCK_MONOTONIC, &now);
+    return (int64_t) now.tv_sec * 1000000 + now.tv_nsec / 1000;
+}
+
+static void Sleep (int us)
+{
+    struct timespec	time = { 0, us * 1000L };
+
+    while (nanosleep (&time, &time) != 0)
+	;
+}
+
+
+static void Blocked (int sig)
+{
+    (void) sig;
+    printf ("Blocked on a band that was never transferred\n");
+    fflush (stdout);
+    _exit (1);
+}
+
+
+//
+// Tests
+//
+
+// with the DMA2D held, a frame is drawn into the other buffer, and a
+//  band of a buffer that is being transferred waits for its fence
+static void TestPingPong (void)
+{
+    uint8_t*	first;
+    uint8_t*	second;
+
+    lcd_set_double_buffered (true);
+
+    MockDma2d_Hold (true);
+    signal (SIGALRM, Blocked);
+    alarm (5);
+
+    first = lcd_get_frame_buffer ();
+    DrawFrame (1);
+    second = lcd_get_frame_buffer ();
+    CHECK (second != first, "frame not drawn into the other buffer");
+
+    DrawFrame (2);
+    CHECK (lcd_get_frame_buffer () == first, "buffers not used in turn");
+    CHECK (DMA2D->CR & DMA2D_CR_START, "DMA2D not started");
+
+    alarm (0);
+    MockDma2d_Hold (false);
+
+    // the first buffer is free once its bands are transferred
+    DrawFrame (3);
+    CHECK (CheckPanel () == 0, "ping-pong frames");
+}
+
+// with a slow DMA2D, frames are drawn while the last one is transferred
+static void TestDoubleBuffered (void)
+{
+    tMockDma2dStats	stats;
+    uint32_t		frame;
+    int			overlapped = 0;
+
+    lcd_set_double_buffered (true);
+    MockDma2d_SetPixelTime (PIXELTIME);
+
+    for (frame = 0; frame < 40; frame++)
+    {
+	if (DMA2D->CR & DMA2D_CR_START)
+	    overlapped++;
+	DrawFrame (frame);
+    }
+    CHECK (CheckPanel () == 0, "double buffered frames");
+    CHECK (overlapped > 20, "%d of 40 frames drawn while a transfer ran", overlapped);
+
+    MockDma2d_SetPixelTime (0);
+    MockDma2d_GetStats (&stats);
+    CHECK (stats.sourceWrites == 0, "%u bands drawn into while transferred", stats.sourceWrites);
+}
+
+// with a single buffer, only the bands that changed are drawn and refreshed,
+//  each after its fence
+static void TestSingleBuffered (void)
+{
+    tMockDma2dStats	stats;
+    uint32_t		frame;
+    uint32_t		bands;
+    int			band;
+
+    lcd_set_double_buffered (false);
+    MockDma2d_SetPixelTime (PIXELTIME);
+
+    for (frame = 100; frame < 200; frame++)
+    {
+	bands = Random32 () | (1u << (frame % LCD_REFRESH_BANDS));
+	for (band = 0; band < LCD_REFRESH_BANDS; band++)
+	{
+	    if (bands & (1u << band))
+	    {
+		lcd_sync_band (band);
+		DrawBand (band, frame);
+		lcd_refresh_band (band);
+	    }
+	}
+	lcd_refresh_end ();
+
+	if (frame % 25 == 0)
+	    CHECK (CheckPanel () == 0, "single buffered frame %u", frame);
+    }
+    CHECK (CheckPanel () == 0, "single buffered frames");
+
+    MockDma2d_SetPixelTime (0);
+    MockDma2d_GetStats (&stats);
+    CHECK (stats.sourceWrites == 0, "%u bands drawn into while transferred", stats.sourceWrites);
+}
+
+// frames converted band by band, as I_FinishUpdate does, timed to the
+//  panel, and one after the other
+static void TestTiming (void)
+{
+    int64_t	start;
+    int64_t	latency;
+    int64_t	best = INT64_MAX;
+    int64_t	total = 0;
+    int64_t	period = 0;
+    uint32_t	frame;
+    int		band;
+
+    // buffered as the adapter starts out
+    lcd_set_double_buffered (LCD_REFRESH_BANDS == 1);
+    MockDma2d_SetPixelTime (transfertime * 1000 / (LCD_MAX_X * LCD_MAX_Y));
+
+    for (frame = 0; frame < 40; frame++)
+    {
+	start = Microseconds ();
+	for (band = 0; band < LCD_REFRESH_BANDS; band++)
+	{
+	    lcd_sync_band (band);
+	    Sleep (converttime / LCD_REFRESH_BANDS);
+	    DrawBand (band, frame);
+	    lcd_refresh_band (band);
+	}
+	lcd_refresh_end ();
+
+	// the first 20 frames each to the panel, the rest back to back
+	if (frame < 20)
+	{
+	    lcd_sync ();
+	    latency = Microseconds () - start;
+	    total += latency;
+	    if (best > latency)
+		best = latency;
+	}
+	else if (frame == 20)
+	{
+	    period = start;
+	}
+    }
+    lcd_sync ();
+    period = (Microseconds () - period) / 20;
+
+    CHECK (CheckPanel () == 0, "timed frames");
+    MockDma2d_SetPixelTime (0);
+
+    printf ("%d bands, %d us conversion, %d us transfer: "
+	    "%d us to the panel (best %d us), %d us a frame\n",
+	    LCD_REFRESH_BANDS, converttime, transfertime,
+	    (int) (total / 20), (int) best, (int) period);
+
+    // bands hide most of the transfer behind the conversion
+    if (LCD_REFRESH_BANDS > 1)
+	CHECK (best - converttime < transfertime,
+	       "%d us of the %d us transfer after the conversion",
+	       (int) (best - converttime), transfertime);
+}
+
+// frames drawn to a refreshing panel, first as the bands are done, which
+//  tears, then once the vertical blanking is seen, paced to it
+static void TestTearing (void)
+{
+    tMockLcdStats	lcd;
+    tLcdPresentStats	before;
+    tLcdPresentStats	after;
+    uint32_t		unpaced;
+    uint32_t		paced;
+    uint32_t		frame;
+
+    lcd_set_double_buffered (LCD_REFRESH_BANDS == 1);
+    MockDma2d_SetPixelTime (transfertime * 1000 / (LCD_MAX_X * LCD_MAX_Y));
+    MockLcd_Refresh (REFRESHTIME);
+
+    // the line event is not enabled yet, as before LCD_VerticalBlank() is set up
+    for (frame = 400; frame < 420; frame++)
+    {
+	Sleep (Random32 () % REFRESHTIME);
+	DrawFrame (frame);
+    }
+    lcd_sync ();
+    MockLcd_GetStats (&lcd);
+    unpaced = lcd.rowsBehind;
+
+    // frames are paced from the first vertical blanking on
+    MockLcd_EnableVerticalBlank (true);
+    Sleep (2 * REFRESHTIME);
+    lcd_get_present_stats (&before);
+    MockLcd_GetStats (&lcd);
+    paced = lcd.rowsBehind;
+
+    for (frame = 420; frame < 440; frame++)
+    {
+	Sleep (Random32 () % REFRESHTIME);
+	DrawFrame (frame);
+    }
+    CHECK (CheckPanel () == 0, "paced frames");
+    lcd_get_present_stats (&after);
+    MockLcd_GetStats (&lcd);
+    paced = lcd.rowsBehind - paced;
+
+    MockLcd_Refresh (0);
+    MockDma2d_SetPixelTime (0);
+
+    printf ("%u refreshes: %u rows torn unpaced, %u paced, "
+	    "%u frames in %u vertical blankings, %u missed\n",
+	    lcd.refreshes, unpaced, paced, after.frames - before.frames,
+	    after.vblanks - before.vblanks, after.missed - before.missed);
+
+    CHECK (unpaced > 0, "no rows torn before the frames were paced");
+    // the host may stall a transfer for a few milliseconds, rarely for a refresh
+    CHECK (paced * 4 < unpaced, "%u rows torn paced, %u unpaced", paced, unpaced);
+    CHECK (after.frames - before.frames == 20, "%u of 20 frames paced",
+	   after.frames - before.frames);
+    CHECK (after.missed - before.missed <= 1, "%u vertical blankings missed",
+	   after.missed - before.missed);
+}
+
+// frames stepped by the vertical blanking: each waits for the next, and
+//  the statistics count what happened
+static void TestPacing (void)
+{
+    tMockDma2dStats	dma;
+    tLcdPresentStats	before;
+    tLcdPresentStats	after;
+    uint32_t		transfers;
+    int			i;
+
+    lcd_set_double_buffered (false);
+    lcd_get_present_stats (&before);
+
+    signal (SIGALRM, Blocked);
+    alarm (5);
+
+    // a frame is not transferred until the vertical blanking
+    MockDma2d_GetStats (&dma);
+    transfers = dma.transfers;
+    DrawFrame (500);
+    Sleep (20000);
+    MockDma2d_GetStats (&dma);
+    CHECK (dma.transfers == transfers, "%u transfers before the vertical blanking",
+	   dma.transfers - transfers);
+    MockLcd_VerticalBlank ();
+    CHECK (CheckPanel () == 0, "frame at the vertical blanking");
+
+    // a frame still being transferred at the next vertical blanking misses it
+    MockDma2d_Hold (true);
+    DrawFrame (501);
+    MockLcd_VerticalBlank ();
+    MockLcd_VerticalBlank ();
+    MockDma2d_Hold (false);
+    CHECK (CheckPanel () == 0, "frame that missed a vertical blanking");
+
+    // the game stalls for a while
+    for (i = 0; i < 16; i++)
+	MockLcd_VerticalBlank ();
+    DrawFrame (502);
+    MockLcd_VerticalBlank ();
+    CHECK (CheckPanel () == 0, "frame after a stall");
+
+    alarm (0);
+
+    lcd_get_present_stats (&after);
+    CHECK (after.vblanks - before.vblanks == 20, "%u vertical blankings",
+	   after.vblanks - before.vblanks);
+    CHECK (after.frames - before.frames == 3, "%u frames", after.frames - before.frames);
+    CHECK (after.missed - before.missed == 1, "%u missed", after.missed - before.missed);
+    CHECK (after.maxInterval >= 17, "at most %u vertical blankings between frames",
+	   after.maxInterval);
+}
+
+
+int main (int argc, char** argv)
+{
+    tMockDma2dStats	stats;
+
+    if (argc > 2)
+    {
+	converttime = atoi (argv[1]);
+	transfertime = atoi (argv[2]);
+    }
+
+    // mallocs below 4 GB, the DMA2D addresses are 32 bits
+    mallopt (M_MMAP_MAX, 0);
+
+    lcd_init ();
+    IDraw_Init ();
+    IDraw_Start ();
+
+    TestPingPong ();
+    TestDoubleBuffered ();
+    TestSingleBuffered ();
+    TestTiming ();
+
+    // once the vertical blanking is seen, frames stay paced to it
+    TestTearing ();
+    TestPacing ();
+
+    MockDma2d_GetStats (&stats);
+    CHECK (stats.configErrors == 0, "%u configuration errors", stats.configErrors);
+    CHECK (stats.busyWrites == 0, "%u transfers reconfigured while running", stats.busyWrites);
+
+    printf ("%d checks, %u transfers: %d errors\n", checks, stats.transfers, errors);
+
+    return errors != 0;
+}
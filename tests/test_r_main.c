@@ -0,0 +1,255 @@
+//
+// Copyright(C) 2023 Husqvarna AB
+//
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU General Public License
+// as published by the Free Software Foundation; either version 2
+// of the License, or (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// DESCRIPTION:
+//	Host test of R_PointToAngle and R_PointToDist, bit-exact
+//	against the original octant branches and FixedDiv, over
+//	the map coordinate range.
+//	With -full, every map unit of the map is swept from each
+//	view point.
+//
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "doomdef.h"
+#include "m_fixed.h"
+#include "tables.h"
+#include "r_main.h"
+
+
+static int	errors;
+static long long checks;
+
+
+//
+// The original versions
+//
+
+static int RefSlopeDiv (unsigned int num, unsigned int den)
+{
+    unsigned ans;
+
+    if (den < 512)
+	return SLOPERANGE;
+
+    ans = (num << 3) / (den >> 8);
+
+    return ans <= SLOPERANGE ? ans : SLOPERANGE;
+}
+
+static fixed_t RefFixedDiv (fixed_t a, fixed_t b)
+{
+    if ((abs(a) >> 14) >= abs(b))
+	return (a^b) < 0 ? INT_MIN : INT_MAX;
+
+    return (fixed_t) (((int64_t) a << 16) / b);
+}
+
+static angle_t RefPointToAngle (fixed_t x, fixed_t y)
+{
+    x -= viewx;
+    y -= viewy;
+
+    if ( (!x) && (!y) )
+	return 0;
+
+    if (x>= 0)
+    {
+	if (y>= 0)
+	{
+	    if (x>y)
+		return tantoangle[ RefSlopeDiv(y,x)];		// octant 0
+	    else
+		return ANG90-1-tantoangle[ RefSlopeDiv(x,y)];	// octant 1
+	}
+	else
+	{
+	    y = -y;
+
+	    if (x>y)
+		return -tantoangle[RefSlopeDiv(y,x)];		// octant 8
+	    else
+		return ANG270+tantoangle[ RefSlopeDiv(x,y)];	// octant 7
+	}
+    }
+    else
+    {
+	x = -x;
+
+	if (y>= 0)
+	{
+	    if (x>y)
+		return ANG180-1-tantoangle[ RefSlopeDiv(y,x)];	// octant 3
+	    else
+		return ANG90+ tantoangle[ RefSlopeDiv(x,y)];	// octant 2
+	}
+	else
+	{
+	    y = -y;
+
+	    if (x>y)
+		return ANG180+tantoangle[ RefSlopeDiv(y,x)];	// octant 4
+	    else
+		return ANG270-1-tantoangle[ RefSlopeDiv(x,y)];	// octant 5
+	}
+    }
+}
+
+static fixed_t RefPointToDist (fixed_t x, fixed_t y)
+{
+    int		angle;
+    fixed_t	dx;
+    fixed_t	dy;
+    fixed_t	temp;
+    fixed_t	frac;
+
+    dx = abs(x - viewx);
+    dy = abs(y - viewy);
+
+    if (dy>dx)
+    {
+	temp = dx;
+	dx = dy;
+	dy = temp;
+    }
+
+    if (dx != 0)
+	frac = RefFixedDiv(dy, dx);
+    else
+	frac = 0;
+
+    angle = (tantoangle[frac>>DBITS]+ANG90) >> ANGLETOFINESHIFT;
+
+    return RefFixedDiv (dx, finesine[angle]);
+}
+
+
+static void Check (fixed_t x, fixed_t y)
+{
+    angle_t	gotangle;
+    angle_t	wantangle;
+    fixed_t	gotdist;
+    fixed_t	wantdist;
+
+    checks++;
+
+    gotangle = R_PointToAngle (x, y);
+    wantangle = RefPointToAngle (x, y);
+
+    if (gotangle != wantangle && errors++ < 10)
+	printf ("R_PointToAngle(%d, %d) from (%d, %d) = %u, not %u\n",
+		x, y, viewx, viewy, gotangle, wantangle);
+
+    // Differences that wrap to INT_MIN make the original index
+    //  tantoangle[] out of range, the new code does the same.
+    if (x - viewx == INT_MIN || y - viewy == INT_MIN)
+	return;
+
+    gotdist = R_PointToDist (x, y);
+    wantdist = RefPointToDist (x, y);
+
+    if (gotdist != wantdist && errors++ < 10)
+	printf ("R_PointToDist(%d, %d) from (%d, %d) = %d, not %d\n",
+		x, y, viewx, viewy, gotdist, wantdist);
+}
+
+
+static uint32_t	randstate = 0x9e3779b9;
+
+static uint32_t Random32 (void)
+{
+    // xorshift32
+    randstate ^= randstate << 13;
+    randstate ^= randstate >> 17;
+    randstate ^= randstate << 5;
+    return randstate;
+}
+
+
+// view points: the middle, the corners and edges of the map
+static const fixed_t viewpoints[][2] =
+{
+    { 0, 0 },
+    { INT_MIN, INT_MIN },
+    { INT_MAX, INT_MAX },
+    { INT_MIN, INT_MAX },
+    { 1056 * FRACUNIT, -3616 * FRACUNIT },
+    { -32000 * FRACUNIT + 12345, 17 * FRACUNIT - 3 },
+    { 123 * FRACUNIT + 0x8000, 0 },
+    { 0x7fff, -0x8000 }
+};
+
+#define NUMVIEWPOINTS	(sizeof(viewpoints) / sizeof(*viewpoints))
+
+// coordinates of the edges around a value
+static const fixed_t edgeoffsets[] =
+{
+    0, 1, -1, 2, -2, 511, 512, 513, -511, -512, -513,
+    0xffff, 0x10000, 0x10001, -0x10000, 0x1fffff, 0x200000, 0x200001,
+    0x7fff0000, -0x7fff0000, INT_MAX, INT_MIN
+};
+
+#define NUMEDGEOFFSETS	(sizeof(edgeoffsets) / sizeof(*edgeoffsets))
+
+
+int main (int argc, char** argv)
+{
+    int		full = argc > 1 && !strcmp (argv[1], "-full");
+    long long	randoms = full ? 400000000LL : 10000000LL;
+    int		mapstep = full ? 1 : 61;
+    long long	n;
+    unsigned	v;
+    int		x;
+    int		y;
+    int		i;
+    int		j;
+
+    for (v = 0; v < NUMVIEWPOINTS; v++)
+    {
+	viewx = viewpoints[v][0];
+	viewy = viewpoints[v][1];
+
+	// every map unit, or a coarse grid of them, over the map
+	for (x = -32768; x < 32768; x += mapstep)
+	    for (y = -32768; y < 32768; y += mapstep)
+		Check (x << FRACBITS, y << FRACBITS);
+
+	// quarter units around the view point
+	for (x = -256; x <= 256; x++)
+	    for (y = -256; y <= 256; y++)
+		Check (viewx + x * (FRACUNIT / 4), viewy + y * (FRACUNIT / 4));
+
+	// the edges of the slope ranges and the dy < 2^21 fast path
+	for (i = 0; i < (int) NUMEDGEOFFSETS; i++)
+	    for (j = 0; j < (int) NUMEDGEOFFSETS; j++)
+		Check (viewx + edgeoffsets[i], viewy + edgeoffsets[j]);
+    }
+
+    for (n = 0; n < randoms; n++)
+    {
+	viewx = (fixed_t) Random32 ();
+	viewy = (fixed_t) Random32 ();
+	Check ((fixed_t) Random32 (), (fixed_t) Random32 ());
+
+	// points near the view point
+	x = (fixed_t) Random32 () >> (Random32 () & 31);
+	y = (fixed_t) Random32 () >> (Random32 () & 31);
+	Check (viewx + x, viewy + y);
+    }
+
+    printf ("%lld checks: %d errors\n", checks, errors);
+
+    return errors != 0;
+}